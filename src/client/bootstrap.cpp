@@ -0,0 +1,224 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "bootstrap.h"
+#include "compositor.h"
+#include "connection_thread.h"
+#include "event_queue.h"
+#include "output.h"
+#include "seat.h"
+#include "shm_pool.h"
+#include "wayland_pointer_p.h"
+#include "xdgoutput.h"
+// Qt
+#include <QHash>
+#include <QPointer>
+// wayland
+#include <wayland-client-protocol.h>
+
+namespace KWayland
+{
+namespace Client
+{
+class Q_DECL_HIDDEN Bootstrap::Private
+{
+public:
+    Private(Bootstrap *q, ConnectionThread *connection);
+    void bindAnnounced();
+    void addOutput(quint32 name, quint32 version);
+    void addSeat(quint32 name, quint32 version);
+
+    QPointer<ConnectionThread> connection;
+    QList<Registry::Interface> interfaces = {
+        Registry::Interface::Compositor,
+        Registry::Interface::Shm,
+        Registry::Interface::Seat,
+        Registry::Interface::Output,
+        Registry::Interface::XdgOutputUnstableV1,
+    };
+    EventQueue *queue = nullptr;
+    Registry *registry = nullptr;
+    Compositor *compositor = nullptr;
+    ShmPool *shmPool = nullptr;
+    XdgOutputManager *xdgOutputManager = nullptr;
+    QList<Seat *> seats;
+    QList<Output *> outputs;
+    QHash<Output *, XdgOutput *> xdgOutputs;
+    WaylandPointer<wl_callback, wl_callback_destroy> callback;
+    bool ready = false;
+
+    static const struct wl_callback_listener s_callbackListener;
+
+private:
+    static void callbackDone(void *data, wl_callback *callback, uint32_t serial);
+
+    Bootstrap *q;
+};
+
+#ifndef K_DOXYGEN
+const struct wl_callback_listener Bootstrap::Private::s_callbackListener = {callbackDone};
+#endif
+
+Bootstrap::Private::Private(Bootstrap *q, ConnectionThread *connection)
+    : connection(connection)
+    , q(q)
+{
+}
+
+void Bootstrap::Private::callbackDone(void *data, wl_callback *callback, uint32_t serial)
+{
+    Q_UNUSED(serial)
+    auto b = reinterpret_cast<Bootstrap::Private *>(data);
+    Q_ASSERT(b->callback == callback);
+    b->callback.release();
+    b->ready = true;
+    Q_EMIT b->q->ready();
+}
+
+void Bootstrap::Private::bindAnnounced()
+{
+    if (interfaces.contains(Registry::Interface::Compositor) && registry->hasInterface(Registry::Interface::Compositor)) {
+        const auto announced = registry->interface(Registry::Interface::Compositor);
+        compositor = registry->createCompositor(announced.name, announced.version, q);
+    }
+    if (interfaces.contains(Registry::Interface::Shm) && registry->hasInterface(Registry::Interface::Shm)) {
+        const auto announced = registry->interface(Registry::Interface::Shm);
+        shmPool = registry->createShmPool(announced.name, announced.version, q);
+    }
+    if (interfaces.contains(Registry::Interface::XdgOutputUnstableV1) && registry->hasInterface(Registry::Interface::XdgOutputUnstableV1)) {
+        const auto announced = registry->interface(Registry::Interface::XdgOutputUnstableV1);
+        xdgOutputManager = registry->createXdgOutputManager(announced.name, announced.version, q);
+    }
+    if (interfaces.contains(Registry::Interface::Seat)) {
+        const auto announced = registry->interfaces(Registry::Interface::Seat);
+        for (const auto &seat : announced) {
+            addSeat(seat.name, seat.version);
+        }
+    }
+    if (interfaces.contains(Registry::Interface::Output)) {
+        const auto announced = registry->interfaces(Registry::Interface::Output);
+        for (const auto &output : announced) {
+            addOutput(output.name, output.version);
+        }
+    }
+
+    // the server sends the initial state of all globals bound above before the done event
+    callback.setup(wl_display_sync(connection->display()));
+    queue->addProxy(callback);
+    wl_callback_add_listener(callback, &s_callbackListener, this);
+    connection->flush();
+}
+
+void Bootstrap::Private::addOutput(quint32 name, quint32 version)
+{
+    Output *output = registry->createOutput(name, version, q);
+    outputs << output;
+    if (xdgOutputManager) {
+        xdgOutputs.insert(output, xdgOutputManager->getXdgOutput(output, q));
+    }
+    QObject::connect(output, &Output::removed, q, [this, output] {
+        outputs.removeOne(output);
+        if (XdgOutput *xdgOutput = xdgOutputs.take(output)) {
+            xdgOutput->deleteLater();
+        }
+        output->deleteLater();
+    });
+}
+
+void Bootstrap::Private::addSeat(quint32 name, quint32 version)
+{
+    Seat *seat = registry->createSeat(name, version, q);
+    seats << seat;
+    QObject::connect(seat, &Seat::removed, q, [this, seat] {
+        seats.removeOne(seat);
+        seat->deleteLater();
+    });
+}
+
+Bootstrap::Bootstrap(ConnectionThread *connection, QObject *parent)
+    : QObject(parent)
+    , d(new Private(this, connection))
+{
+}
+
+Bootstrap::~Bootstrap()
+{
+    d->callback.release();
+}
+
+void Bootstrap::setInterfaces(const QList<Registry::Interface> &interfaces)
+{
+    Q_ASSERT(!d->registry);
+    d->interfaces = interfaces;
+}
+
+QList<Registry::Interface> Bootstrap::interfaces() const
+{
+    return d->interfaces;
+}
+
+void Bootstrap::start()
+{
+    Q_ASSERT(!d->registry);
+    if (!d->connection || !d->connection->display()) {
+        return;
+    }
+    d->queue = new EventQueue(this);
+    d->queue->setup(d->connection);
+    d->registry = new Registry(this);
+    d->registry->setInterestedInterfaces(d->interfaces);
+    d->registry->setEventQueue(d->queue);
+    connect(d->registry, &Registry::interfacesAnnounced, this, [this] {
+        d->bindAnnounced();
+    });
+    d->registry->create(d->connection);
+    d->registry->setup();
+    d->connection->flush();
+}
+
+bool Bootstrap::isReady() const
+{
+    return d->ready;
+}
+
+Registry *Bootstrap::registry() const
+{
+    return d->registry;
+}
+
+EventQueue *Bootstrap::eventQueue() const
+{
+    return d->queue;
+}
+
+Compositor *Bootstrap::compositor() const
+{
+    return d->compositor;
+}
+
+ShmPool *Bootstrap::shmPool() const
+{
+    return d->shmPool;
+}
+
+QList<Seat *> Bootstrap::seats() const
+{
+    return d->seats;
+}
+
+QList<Output *> Bootstrap::outputs() const
+{
+    return d->outputs;
+}
+
+XdgOutput *Bootstrap::xdgOutput(Output *output) const
+{
+    return d->xdgOutputs.value(output);
+}
+
+}
+}
+
+#include "moc_bootstrap.cpp"
@@ -0,0 +1,130 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#ifndef WAYLAND_BOOTSTRAP_H
+#define WAYLAND_BOOTSTRAP_H
+
+#include <QObject>
+
+#include "KWayland/Client/kwaylandclient_export.h"
+#include "registry.h"
+
+namespace KWayland
+{
+namespace Client
+{
+class Compositor;
+class ConnectionThread;
+class EventQueue;
+class Output;
+class Seat;
+class ShmPool;
+class XdgOutput;
+
+/**
+ * @short Sets up the commonly used globals of a Wayland connection at once.
+ *
+ * Getting a usable client requires announcing the globals through the Registry, binding them
+ * and waiting for their initial state, like the modes of an Output or the capabilities of a Seat.
+ * Doing this step by step costs one roundtrip for each kind of global. The Bootstrap binds all
+ * declared globals as soon as the Registry announced them and waits for their initial state with
+ * a single wl_display_sync. Once ready is emitted all objects are fully populated:
+ *
+ * @code
+ * Bootstrap *bootstrap = new Bootstrap(connection);
+ * bootstrap->setInterfaces({Registry::Interface::Compositor, Registry::Interface::Shm, Registry::Interface::Output});
+ * connect(bootstrap, &Bootstrap::ready, bootstrap, [bootstrap] {
+ *     for (Output *output : bootstrap->outputs()) {
+ *         qDebug() << output->model() << output->pixelSize();
+ *     }
+ * });
+ * bootstrap->start();
+ * @endcode
+ *
+ * The Bootstrap creates the Compositor, the ShmPool, all Seats, all Outputs and an XdgOutput
+ * for each Output if the respective Registry::Interface is declared. Other declared interfaces
+ * are not bound, but are accessible through the Registry, e.g. with Registry::lazyManager.
+ * The Registry only handles the declared interfaces, see Registry::setInterestedInterfaces.
+ *
+ * Only the globals announced before ready are bound. Globals announced later on can be handled
+ * through the Registry.
+ *
+ * @since 6.7
+ **/
+class KWAYLANDCLIENT_EXPORT Bootstrap : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * Creates a Bootstrap for the established @p connection.
+     **/
+    explicit Bootstrap(ConnectionThread *connection, QObject *parent = nullptr);
+    ~Bootstrap() override;
+
+    /**
+     * Declares the @p interfaces to bind. Must be called before start.
+     * The default is Compositor, Shm, Seat, Output and XdgOutputUnstableV1.
+     **/
+    void setInterfaces(const QList<Registry::Interface> &interfaces);
+    /**
+     * @returns The declared interfaces
+     **/
+    QList<Registry::Interface> interfaces() const;
+
+    /**
+     * Creates the Registry and starts binding the declared interfaces.
+     * Once their initial state is known ready is emitted.
+     **/
+    void start();
+    /**
+     * @returns @c true once the initial state of all bound globals is known
+     * @see ready
+     **/
+    bool isReady() const;
+
+    /**
+     * @returns The Registry, @c null before start
+     **/
+    Registry *registry() const;
+    /**
+     * @returns The EventQueue all objects of the Bootstrap are dispatched in, @c null before start
+     **/
+    EventQueue *eventQueue() const;
+    /**
+     * @returns The Compositor or @c null if not declared or not announced
+     **/
+    Compositor *compositor() const;
+    /**
+     * @returns The ShmPool or @c null if not declared or not announced
+     **/
+    ShmPool *shmPool() const;
+    /**
+     * @returns All bound Seats which have not been removed
+     **/
+    QList<Seat *> seats() const;
+    /**
+     * @returns All bound Outputs which have not been removed
+     **/
+    QList<Output *> outputs() const;
+    /**
+     * @returns The XdgOutput for @p output or @c null if XdgOutputUnstableV1 is not declared or not announced
+     **/
+    XdgOutput *xdgOutput(Output *output) const;
+
+Q_SIGNALS:
+    /**
+     * Emitted once all declared globals are bound and their initial state is known.
+     **/
+    void ready();
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+}
+}
+
+#endif
@@ -6,6 +6,9 @@
 #include "buffer.h"
 #include "buffer_p.h"
 #include "shm_pool.h"
+// Qt
+#include <QImage>
+#include <QRegion>
 // system
 #include <string.h>
 // wayland
@@ -43,6 +46,35 @@ void Buffer::Private::destroy()
     nativeBuffer.destroy();
 }
 
+QImage::Format Buffer::Private::toImageFormat(Format format)
+{
+    switch (format) {
+    case Format::ARGB32:
+        return QImage::Format_ARGB32_Premultiplied;
+    case Format::RGB32:
+        return QImage::Format_RGB32;
+    case Format::RGB16:
+        return QImage::Format_RGB16;
+    case Format::RGBA8888:
+        return QImage::Format_RGBA8888_Premultiplied;
+    case Format::RGBX8888:
+        return QImage::Format_RGBX8888;
+    case Format::A2RGB30:
+        return QImage::Format_A2RGB30_Premultiplied;
+    case Format::RGB30:
+        return QImage::Format_RGB30;
+    case Format::A2BGR30:
+        return QImage::Format_A2BGR30_Premultiplied;
+    case Format::BGR30:
+        return QImage::Format_BGR30;
+    case Format::RGBA64:
+        return QImage::Format_RGBA64_Premultiplied;
+    case Format::RGBX64:
+        return QImage::Format_RGBX64;
+    }
+    Q_UNREACHABLE();
+}
+
 void Buffer::Private::releasedCallback(void *data, wl_buffer *buffer)
 {
     auto b = reinterpret_cast<Buffer::Private *>(data);
@@ -62,6 +94,28 @@ void Buffer::copy(const void *src)
     memcpy(address(), src, d->size.height() * d->stride);
 }
 
+void Buffer::copy(const void *src, const QRegion &damage)
+{
+    const QRegion clipped = damage.intersected(QRect(QPoint(0, 0), d->size));
+    const int bpp = bytesPerPixel(d->format);
+    const uchar *source = reinterpret_cast<const uchar *>(src);
+    uchar *target = address();
+    for (const QRect &rect : clipped) {
+        if (rect.width() == d->size.width()) {
+            // complete lines are contiguous, copy them at once
+            const size_t offset = size_t(rect.y()) * d->stride;
+            memcpy(target + offset, source + offset, size_t(rect.height()) * d->stride);
+            continue;
+        }
+        const size_t lineOffset = size_t(rect.x()) * bpp;
+        const size_t lineLength = size_t(rect.width()) * bpp;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            const size_t offset = size_t(y) * d->stride + lineOffset;
+            memcpy(target + offset, source + offset, lineLength);
+        }
+    }
+}
+
 uchar *Buffer::address()
 {
     return reinterpret_cast<uchar *>(d->shm->poolAddress()) + d->offset;
@@ -117,6 +171,35 @@ Buffer::Format Buffer::format() const
     return d->format;
 }
 
+QImage Buffer::image()
+{
+    if (!d->shm->poolAddress()) {
+        return QImage();
+    }
+    return QImage(address(), d->size.width(), d->size.height(), d->stride, Private::toImageFormat(d->format));
+}
+
+int Buffer::bytesPerPixel(Format format)
+{
+    switch (format) {
+    case Format::RGB16:
+        return 2;
+    case Format::ARGB32:
+    case Format::RGB32:
+    case Format::RGBA8888:
+    case Format::RGBX8888:
+    case Format::A2RGB30:
+    case Format::RGB30:
+    case Format::A2BGR30:
+    case Format::BGR30:
+        return 4;
+    case Format::RGBA64:
+    case Format::RGBX64:
+        return 8;
+    }
+    Q_UNREACHABLE();
+}
+
 quint32 Buffer::getId(wl_buffer *b)
 {
     return wl_proxy_get_id(reinterpret_cast<wl_proxy *>(b));
@@ -12,6 +12,9 @@
 
 #include "KWayland/Client/kwaylandclient_export.h"
 
+class QImage;
+class QRegion;
+
 struct wl_buffer;
 
 namespace KWayland
@@ -36,6 +39,15 @@ public:
     enum class Format {
         ARGB32, ///< 32-bit ARGB format, can be used for QImage::Format_ARGB32 and QImage::Format_ARGB32_Premultiplied
         RGB32, ///< 32-bit RGB format, can be used for QImage::Format_RGB32
+        RGB16, ///< 16-bit RGB 5-6-5 format, can be used for QImage::Format_RGB16 @since 6.7
+        RGBA8888, ///< 32-bit byte-ordered RGBA format, can be used for QImage::Format_RGBA8888_Premultiplied @since 6.7
+        RGBX8888, ///< 32-bit byte-ordered RGB format, can be used for QImage::Format_RGBX8888 @since 6.7
+        A2RGB30, ///< 32-bit ARGB 2-10-10-10 format, can be used for QImage::Format_A2RGB30_Premultiplied @since 6.7
+        RGB30, ///< 32-bit RGB 10-10-10 format, can be used for QImage::Format_RGB30 @since 6.7
+        A2BGR30, ///< 32-bit ABGR 2-10-10-10 format, can be used for QImage::Format_A2BGR30_Premultiplied @since 6.7
+        BGR30, ///< 32-bit BGR 10-10-10 format, can be used for QImage::Format_BGR30 @since 6.7
+        RGBA64, ///< 64-bit RGBA 16-16-16-16 format, can be used for QImage::Format_RGBA64_Premultiplied @since 6.7
+        RGBX64, ///< 64-bit RGB 16-16-16 format, can be used for QImage::Format_RGBX64 @since 6.7
     };
 
     ~Buffer();
@@ -43,6 +55,13 @@ public:
      * Copies the data from @p src into the Buffer.
      **/
     void copy(const void *src);
+    /**
+     * Copies the @p damage region from @p src into the Buffer. The @p src has to have
+     * the same size, stride and format as the Buffer. Only the lines and spans covered by
+     * @p damage are copied, the remaining content of the Buffer is not touched.
+     * @since 6.7
+     **/
+    void copy(const void *src, const QRegion &damage);
     /**
      * Sets the Buffer as @p released.
      * This is automatically invoked when the Wayland server sends the release event.
@@ -89,6 +108,31 @@ public:
      * @returns The image format used by this Buffer.
      **/
     Format format() const;
+    /**
+     * Creates a QImage which directly uses the memory of this Buffer, thus anything painted
+     * on the image ends up in the Buffer without any copy. The returned QImage does not own
+     * the memory, it is only valid as long as this Buffer exists and the ShmPool does not get
+     * mapped again (see ShmPool::poolResized).
+     *
+     * While painting on the image the Buffer should be marked as used, so that the ShmPool
+     * does not hand it out again:
+     * @code
+     * auto buffer = pool->getBuffer(size, size.width() * 4, Buffer::Format::ARGB32).toStrongRef();
+     * buffer->setUsed(true);
+     * QImage image = buffer->image();
+     * QPainter painter(&image);
+     * // paint
+     * painter.end();
+     * surface->attachBuffer(buffer);
+     * surface->damage(image.rect());
+     * surface->commit();
+     * buffer->setUsed(false);
+     * @endcode
+     *
+     * @returns QImage sharing the memory of this Buffer, a null QImage if the Buffer is not mapped
+     * @since 6.7
+     **/
+    QImage image();
 
     operator wl_buffer *();
     operator wl_buffer *() const;
@@ -101,6 +145,13 @@ public:
      **/
     static quint32 getId(wl_buffer *b);
 
+    /**
+     * @returns the number of bytes a single pixel of @p format occupies, e.g. to calculate
+     * the stride for ShmPool::getBuffer
+     * @since 6.7
+     **/
+    static int bytesPerPixel(Format format);
+
 private:
     friend class ShmPool;
     explicit Buffer(ShmPool *parent, wl_buffer *buffer, const QSize &size, int32_t stride, size_t offset, Format format);
@@ -7,6 +7,8 @@
 #define WAYLAND_BUFFER_P_H
 #include "buffer.h"
 #include "wayland_pointer_p.h"
+// Qt
+#include <QImage>
 // wayland
 #include <wayland-client-protocol.h>
 
@@ -20,6 +22,7 @@ public:
     Private(Buffer *q, ShmPool *parent, wl_buffer *nativeBuffer, const QSize &size, int32_t stride, size_t offset, Format format);
     ~Private();
     void destroy();
+    static QImage::Format toImageFormat(Format format);
 
     ShmPool *shm;
     WaylandPointer<wl_buffer, wl_buffer_destroy> nativeBuffer;
@@ -29,6 +32,9 @@ public:
     size_t offset;
     bool used;
     Format format;
+    // identifies the content last copied in by ShmPool::createBuffer and its frame
+    quint64 contentId = 0;
+    quint64 contentSerial = 0;
 
 private:
     Buffer *q;
@@ -14,11 +14,15 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QSocketNotifier>
+#include <QThread>
 #include <qpa/qplatformnativeinterface.h>
 // Wayland
 #include <wayland-client-protocol.h>
 
+#include <errno.h>
 #include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace KWayland
 {
@@ -33,6 +37,11 @@ public:
     void setupSocketNotifier();
     void setupSocketFileWatcher();
     void dispatchEvents();
+    void dispatchPending();
+    void setupReaderThread();
+    void stopReaderThread();
+    void readEventsLoop();
+    void notifyQueues();
 
     wl_display *display = nullptr;
     int fd = -1;
@@ -44,6 +53,16 @@ public:
     bool foreign = false;
     QMetaObject::Connection eventDispatcherConnection;
     int error = 0;
+    bool dedicatedReader = false;
+    QScopedPointer<QThread> readerThread;
+    // eventfd to interrupt the reader thread
+    int readerWakeFd = -1;
+    // eventfd the reader thread signals to dispatch the default queue
+    int dispatchFd = -1;
+    QScopedPointer<QSocketNotifier> dispatchNotifier;
+    // eventfds of the EventQueues to signal after new events got read
+    QList<int> queueFds;
+    QMutex queueFdsMutex;
     static QList<ConnectionThread *> connections;
     static QRecursiveMutex mutex;
 
@@ -74,6 +93,7 @@ ConnectionThread::Private::~Private()
         QMutexLocker lock(&mutex);
         connections.removeOne(q);
     }
+    stopReaderThread();
     if (display && !foreign) {
         wl_display_flush(display);
         wl_display_disconnect(display);
@@ -99,7 +119,11 @@ void ConnectionThread::Private::doInitConnection()
     }
 
     // setup socket notifier
-    setupSocketNotifier();
+    if (dedicatedReader) {
+        setupReaderThread();
+    } else {
+        setupSocketNotifier();
+    }
     setupSocketFileWatcher();
     Q_EMIT q->connected();
 }
@@ -136,9 +160,15 @@ void ConnectionThread::Private::dispatchEvents()
     }
 
     // finally, dispatch the default queue and all frame queues
+    dispatchPending();
+}
+
+void ConnectionThread::Private::dispatchPending()
+{
     if (wl_display_dispatch_pending(display) == -1) {
         error = wl_display_get_error(display);
         if (error != 0) {
+            stopReaderThread();
             if (display) {
                 free(display);
                 display = nullptr;
@@ -150,6 +180,100 @@ void ConnectionThread::Private::dispatchEvents()
     Q_EMIT q->eventsRead();
 }
 
+void ConnectionThread::Private::setupReaderThread()
+{
+    readerWakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    dispatchFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (readerWakeFd == -1 || dispatchFd == -1) {
+        qCWarning(KWAYLAND_CLIENT) << "Could not create eventfd for reader thread, falling back to socket notifier";
+        stopReaderThread();
+        // EventQueues must not wait for a reader thread which does not exist
+        dedicatedReader = false;
+        setupSocketNotifier();
+        return;
+    }
+    dispatchNotifier.reset(new QSocketNotifier(dispatchFd, QSocketNotifier::Read));
+    QObject::connect(dispatchNotifier.data(), &QSocketNotifier::activated, q, [this]() {
+        eventfd_t value;
+        eventfd_read(dispatchFd, &value);
+        if (!display) {
+            return;
+        }
+        dispatchPending();
+    });
+    readerThread.reset(QThread::create([this]() {
+        readEventsLoop();
+    }));
+    readerThread->setObjectName(QStringLiteral("KWaylandReader"));
+    readerThread->start();
+}
+
+void ConnectionThread::Private::stopReaderThread()
+{
+    if (readerThread) {
+        eventfd_write(readerWakeFd, 1);
+        readerThread->wait();
+        readerThread.reset();
+    }
+    if (dispatchNotifier) {
+        // might be invoked from the notifier's activated signal
+        dispatchNotifier->setEnabled(false);
+        dispatchNotifier.take()->deleteLater();
+    }
+    if (readerWakeFd != -1) {
+        close(readerWakeFd);
+        readerWakeFd = -1;
+    }
+    if (dispatchFd != -1) {
+        close(dispatchFd);
+        dispatchFd = -1;
+    }
+}
+
+void ConnectionThread::Private::readEventsLoop()
+{
+    // an own queue without any proxies, it never has pending events so preparing
+    // the read does not depend on other threads dispatching their queues
+    wl_event_queue *readerQueue = wl_display_create_queue(display);
+    struct pollfd pfds[2];
+    pfds[0].fd = wl_display_get_fd(display);
+    pfds[0].events = POLLIN;
+    pfds[1].fd = readerWakeFd;
+    pfds[1].events = POLLIN;
+    while (true) {
+        if (wl_display_prepare_read_queue(display, readerQueue) != 0) {
+            break;
+        }
+        if (poll(pfds, 2, -1) < 0) {
+            wl_display_cancel_read(display);
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (pfds[1].revents & POLLIN) {
+            wl_display_cancel_read(display);
+            break;
+        }
+        const bool failed = wl_display_read_events(display) == -1;
+        // also wake up on failure, dispatching on the owning thread reports the error
+        notifyQueues();
+        if (failed) {
+            break;
+        }
+    }
+    wl_event_queue_destroy(readerQueue);
+}
+
+void ConnectionThread::Private::notifyQueues()
+{
+    eventfd_write(dispatchFd, 1);
+    QMutexLocker lock(&queueFdsMutex);
+    for (int fd : std::as_const(queueFds)) {
+        eventfd_write(fd, 1);
+    }
+}
+
 void ConnectionThread::Private::setupSocketFileWatcher()
 {
     if (!runtimeDir.exists() || fd != -1) {
@@ -163,6 +287,7 @@ void ConnectionThread::Private::setupSocketFileWatcher()
         }
         qCWarning(KWAYLAND_CLIENT) << "Connection to server went away";
         serverDied = true;
+        stopReaderThread();
         if (display) {
             free(display);
             display = nullptr;
@@ -270,6 +395,32 @@ void ConnectionThread::setSocketFd(int fd)
     d->fd = fd;
 }
 
+void ConnectionThread::setDedicatedReaderThread(bool enable)
+{
+    if (d->display) {
+        // already initialized
+        return;
+    }
+    d->dedicatedReader = enable;
+}
+
+bool ConnectionThread::hasDedicatedReaderThread() const
+{
+    return d->dedicatedReader && !d->foreign;
+}
+
+void ConnectionThread::registerQueueNotifier(int fd)
+{
+    QMutexLocker lock(&d->queueFdsMutex);
+    d->queueFds << fd;
+}
+
+void ConnectionThread::unregisterQueueNotifier(int fd)
+{
+    QMutexLocker lock(&d->queueFdsMutex);
+    d->queueFds.removeOne(fd);
+}
+
 wl_display *ConnectionThread::display()
 {
     return d->display;
@@ -78,6 +78,17 @@ namespace Client
  * Furthermore this class flushes the Wayland connection whenever the QAbstractEventDispatcher
  * is about to block.
  *
+ * By default the Wayland socket is read from the thread the ConnectionThread lives in, so
+ * a busy event loop in that thread delays all events. Alternatively a dedicated reader thread
+ * can be enabled before initializing the connection. That thread blocks on the Wayland socket,
+ * reads the events as soon as they arrive and wakes the ConnectionThread and every EventQueue
+ * set up for this connection directly through an eventfd:
+ *
+ * @code
+ * connection->setDedicatedReaderThread(true);
+ * connection->initConnection();
+ * @endcode
+ *
  * To disconnect the connection to the Wayland server one should delete the instance of this
  * class and quit the dedicated thread:
  *
@@ -160,6 +171,32 @@ public:
      **/
     void setSocketFd(int fd);
 
+    /**
+     * Sets whether the Wayland socket is read from a dedicated reader thread.
+     * Only applies if called before calling initConnection and is ignored for a
+     * ConnectionThread created through fromApplication.
+     *
+     * When enabled an internal thread blocks on the Wayland socket and reads events
+     * as soon as they arrive, independently of how busy the thread of the ConnectionThread
+     * is. The default queue is still dispatched in the thread of the ConnectionThread and
+     * each EventQueue set up for this connection is still dispatched in its own thread.
+     * Instead of relying on the queued eventsRead signal the reader thread wakes them
+     * through an eventfd. The signal eventsRead is still emitted after the default queue
+     * got dispatched.
+     *
+     * By default the dedicated reader thread is disabled.
+     *
+     * @see hasDedicatedReaderThread
+     * @since 6.7
+     **/
+    void setDedicatedReaderThread(bool enable);
+    /**
+     * @returns whether the Wayland socket is read from a dedicated reader thread
+     * @see setDedicatedReaderThread
+     * @since 6.7
+     **/
+    bool hasDedicatedReaderThread() const;
+
     /**
      * Trigger a blocking roundtrip to the Wayland server. Ensures that all events are processed
      * before returning to the event loop.
@@ -252,6 +289,9 @@ private Q_SLOTS:
     void doInitConnection();
 
 private:
+    friend class EventQueue;
+    void registerQueueNotifier(int fd);
+    void unregisterQueueNotifier(int fd);
     class Private;
     QScopedPointer<Private> d;
 };
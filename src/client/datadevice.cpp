@@ -4,10 +4,14 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
 */
 #include "datadevice.h"
+#include "dataoffer.h"
 #include "datasource.h"
+#include "datatransfer.h"
 #include "surface.h"
 #include "wayland_pointer_p.h"
 // Qt
+#include <QCryptographicHash>
+#include <QHash>
 #include <QPointer>
 // Wayland
 #include <wayland-client-protocol.h>
@@ -30,8 +34,23 @@ public:
     };
     Drag drag;
 
+    struct CachedSelection {
+        QByteArray data;
+        QByteArray hash;
+        // false while the prefetch is running
+        bool complete = false;
+        QPointer<DataTransfer> transfer;
+    };
+    QStringList prefetchMimeTypes;
+    qint64 prefetchMaximumSize = 1024 * 1024;
+    QHash<QString, CachedSelection> selectionCache;
+
+    void prefetchSelection(bool selectionChanged);
+    void cancelPrefetch(CachedSelection &entry);
+
 private:
     void dataOffer(wl_data_offer *id);
+    void prefetchFinished(const QString &mimeType, DataTransfer *transfer);
     void selection(wl_data_offer *id);
     void dragEnter(quint32 serial, const QPointer<Surface> &surface, const QPointF &relativeToSurface, wl_data_offer *dataOffer);
     void dragLeft();
@@ -123,15 +142,91 @@ void DataDevice::Private::selectionCallback(void *data, wl_data_device *dataDevi
 void DataDevice::Private::selection(wl_data_offer *id)
 {
     if (!id) {
+        for (CachedSelection &entry : selectionCache) {
+            cancelPrefetch(entry);
+        }
         selectionOffer.reset();
+        selectionCache.clear();
         Q_EMIT q->selectionCleared();
         return;
     }
     Q_ASSERT(*lastOffer == id);
     selectionOffer = std::move(lastOffer);
+    prefetchSelection(true);
     Q_EMIT q->selectionOffered(selectionOffer.get());
 }
 
+void DataDevice::Private::prefetchSelection(bool selectionChanged)
+{
+    const QStringList offered = selectionOffer && !prefetchMimeTypes.isEmpty() ? selectionOffer->offeredMimeTypeNames() : QStringList();
+    for (auto it = selectionCache.begin(); it != selectionCache.end();) {
+        if (offered.contains(it.key())) {
+            ++it;
+        } else {
+            cancelPrefetch(*it);
+            it = selectionCache.erase(it);
+        }
+    }
+    for (const QString &mimeType : std::as_const(prefetchMimeTypes)) {
+        if (!offered.contains(mimeType)) {
+            continue;
+        }
+        // the previous data is kept to detect identical data
+        CachedSelection &entry = selectionCache[mimeType];
+        if (!selectionChanged && (entry.complete || entry.transfer)) {
+            continue;
+        }
+        cancelPrefetch(entry);
+        entry.complete = false;
+        DataTransfer *transfer = selectionOffer->receiveData(mimeType);
+        // the size is checked once per activation, which reads up to 16 chunks
+        transfer->setChunkSize(qBound(qint64(4096), prefetchMaximumSize / 16, transfer->chunkSize()));
+        entry.transfer = transfer;
+        QObject::connect(transfer, &DataTransfer::progress, q, [this, transfer](qint64 transferred) {
+            if (transferred > prefetchMaximumSize) {
+                transfer->cancel();
+            }
+        });
+        QObject::connect(transfer, &DataTransfer::finished, q, [this, mimeType, transfer] {
+            prefetchFinished(mimeType, transfer);
+        });
+    }
+}
+
+void DataDevice::Private::cancelPrefetch(CachedSelection &entry)
+{
+    // cleared first, so that the finished transfer does not touch the cache any more
+    DataTransfer *transfer = entry.transfer;
+    entry.transfer.clear();
+    if (transfer) {
+        transfer->cancel();
+    }
+}
+
+void DataDevice::Private::prefetchFinished(const QString &mimeType, DataTransfer *transfer)
+{
+    transfer->deleteLater();
+    auto it = selectionCache.find(mimeType);
+    if (it == selectionCache.end() || it->transfer != transfer) {
+        // the selection changed in the meantime
+        return;
+    }
+    if (transfer->state() != DataTransfer::State::Finished) {
+        selectionCache.erase(it);
+        return;
+    }
+    const QByteArray data = transfer->data();
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    const bool changed = hash != it->hash;
+    if (changed) {
+        it->data = data;
+        it->hash = hash;
+    }
+    it->complete = true;
+    it->transfer.clear();
+    Q_EMIT q->selectionDataPrefetched(mimeType, changed);
+}
+
 DataDevice::Private::Private(DataDevice *q)
     : q(q)
 {
@@ -232,6 +327,32 @@ std::unique_ptr<DataOffer> DataDevice::takeDragOffer()
     return std::move(d->drag.offer);
 }
 
+void DataDevice::setSelectionPrefetch(const QStringList &mimeTypes, qint64 maximumSize)
+{
+    d->prefetchMimeTypes = mimeTypes;
+    d->prefetchMaximumSize = maximumSize;
+    d->prefetchSelection(false);
+}
+
+QStringList DataDevice::selectionPrefetchMimeTypes() const
+{
+    return d->prefetchMimeTypes;
+}
+
+qint64 DataDevice::selectionPrefetchMaximumSize() const
+{
+    return d->prefetchMaximumSize;
+}
+
+QByteArray DataDevice::cachedSelectionData(const QString &mimeType) const
+{
+    const auto it = d->selectionCache.constFind(mimeType);
+    if (it == d->selectionCache.constEnd() || !it->complete) {
+        return QByteArray();
+    }
+    return it->data;
+}
+
 DataDevice::operator wl_data_device *()
 {
     return d->device;
@@ -89,6 +89,45 @@ public:
     DataOffer *dragOffer() const;
     std::unique_ptr<DataOffer> takeDragOffer();
 
+    /**
+     * Enables prefetching the selection for the given @p mimeTypes, an empty list disables it.
+     *
+     * Whenever a selection is offered which offers one of the @p mimeTypes, its data is received
+     * in the background and cached, unless it exceeds @p maximumSize bytes. Once prefetched the
+     * data is available through cachedSelectionData without another request to the DataSource.
+     * Data identical to the previous selection is detected by its hash, see
+     * selectionDataPrefetched.
+     *
+     * The size is checked while receiving, so up to about @p maximumSize (at least 64 KiB) more
+     * bytes might be buffered before an oversized prefetch is given up.
+     *
+     * Prefetching is disabled by default.
+     * @see cachedSelectionData
+     * @see selectionDataPrefetched
+     * @since 6.7
+     **/
+    void setSelectionPrefetch(const QStringList &mimeTypes, qint64 maximumSize = 1024 * 1024);
+    /**
+     * @returns the mime types for which the selection gets prefetched
+     * @see setSelectionPrefetch
+     * @since 6.7
+     **/
+    QStringList selectionPrefetchMimeTypes() const;
+    /**
+     * @returns the maximum size in bytes of prefetched selection data
+     * @see setSelectionPrefetch
+     * @since 6.7
+     **/
+    qint64 selectionPrefetchMaximumSize() const;
+    /**
+     * @returns the prefetched data of the current selection for @p mimeType or a null QByteArray
+     * if it is not prefetched, e.g. because the prefetch is still running
+     * @see setSelectionPrefetch
+     * @see selectionDataPrefetched
+     * @since 6.7
+     **/
+    QByteArray cachedSelectionData(const QString &mimeType) const;
+
     operator wl_data_device *();
     operator wl_data_device *() const;
 
@@ -135,6 +174,15 @@ Q_SIGNALS:
      **/
     void dropped();
 
+    /**
+     * Emitted when the data of the current selection for @p mimeType got prefetched.
+     * @p changed is @c false if the data is identical to the previous selection's one.
+     * @see setSelectionPrefetch
+     * @see cachedSelectionData
+     * @since 6.7
+     **/
+    void selectionDataPrefetched(const QString &mimeType, bool changed);
+
 private:
     class Private;
     QScopedPointer<Private> d;
@@ -5,12 +5,20 @@
 */
 #include "dataoffer.h"
 #include "datadevice.h"
+#include "datatransfer.h"
 #include "wayland_pointer_p.h"
 // Qt
+#include <QHash>
+#include <QMetaMethod>
 #include <QMimeDatabase>
 #include <QMimeType>
+#include <QMutex>
+#include <QMutexLocker>
 // Wayland
 #include <wayland-client-protocol.h>
+// system
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace KWayland
 {
@@ -21,7 +29,10 @@ class Q_DECL_HIDDEN DataOffer::Private
 public:
     Private(wl_data_offer *offer, DataOffer *q);
     WaylandPointer<wl_data_offer, wl_data_offer_destroy> dataOffer;
+    QStringList mimeTypeNames;
+    // resolved lazily from mimeTypeNames
     QList<QMimeType> mimeTypes;
+    bool mimeTypesResolved = true;
     DataDeviceManager::DnDActions sourceActions = DataDeviceManager::DnDAction::None;
     DataDeviceManager::DnDAction selectedAction = DataDeviceManager::DnDAction::None;
 
@@ -40,6 +51,28 @@ private:
 const struct wl_data_offer_listener DataOffer::Private::s_listener = {offerCallback, sourceActionsCallback, actionCallback};
 #endif
 
+/**
+ * Resolves @p name through a process wide cache, the same mime types are offered over and over.
+ **/
+static QMimeType mimeTypeForName(const QString &name)
+{
+    // mime type names are chosen by other clients, thus the cache is bounded
+    static const int s_maximumCacheSize = 1024;
+    static QMutex s_mutex;
+    static QHash<QString, QMimeType> s_cache;
+
+    QMutexLocker lock(&s_mutex);
+    auto it = s_cache.constFind(name);
+    if (it != s_cache.constEnd()) {
+        return *it;
+    }
+    if (s_cache.size() >= s_maximumCacheSize) {
+        s_cache.clear();
+    }
+    QMimeDatabase db;
+    return *s_cache.insert(name, db.mimeTypeForName(name));
+}
+
 DataOffer::Private::Private(wl_data_offer *offer, DataOffer *q)
     : q(q)
 {
@@ -56,10 +89,17 @@ void DataOffer::Private::offerCallback(void *data, wl_data_offer *dataOffer, con
 
 void DataOffer::Private::offer(const QString &mimeType)
 {
-    QMimeDatabase db;
-    const auto &m = db.mimeTypeForName(mimeType);
+    mimeTypeNames << mimeType;
+    static const QMetaMethod s_offeredSignal = QMetaMethod::fromSignal(&DataOffer::mimeTypeOffered);
+    if (!q->isSignalConnected(s_offeredSignal)) {
+        mimeTypesResolved = false;
+        return;
+    }
+    const QMimeType m = mimeTypeForName(mimeType);
     if (m.isValid()) {
-        mimeTypes << m;
+        if (mimeTypesResolved) {
+            mimeTypes << m;
+        }
         Q_EMIT q->mimeTypeOffered(m.name());
     }
 }
@@ -143,9 +183,25 @@ bool DataOffer::isValid() const
 
 QList<QMimeType> DataOffer::offeredMimeTypes() const
 {
+    if (!d->mimeTypesResolved) {
+        d->mimeTypes.clear();
+        d->mimeTypes.reserve(d->mimeTypeNames.count());
+        for (const QString &name : std::as_const(d->mimeTypeNames)) {
+            const QMimeType m = mimeTypeForName(name);
+            if (m.isValid()) {
+                d->mimeTypes << m;
+            }
+        }
+        d->mimeTypesResolved = true;
+    }
     return d->mimeTypes;
 }
 
+QStringList DataOffer::offeredMimeTypeNames() const
+{
+    return d->mimeTypeNames;
+}
+
 void DataOffer::accept(const QMimeType &mimeType, quint32 serial)
 {
     accept(mimeType.name(), serial);
@@ -167,6 +223,22 @@ void DataOffer::receive(const QString &mimeType, qint32 fd)
     wl_data_offer_receive(d->dataOffer, mimeType.toUtf8().constData(), fd);
 }
 
+DataTransfer *DataOffer::receiveData(const QString &mimeType, QIODevice *device)
+{
+    Q_ASSERT(isValid());
+    int pipeFds[2];
+    // only the read end may be non-blocking, the source might write with a single blocking write;
+    // DataTransfer makes the read end non-blocking
+    if (pipe2(pipeFds, O_CLOEXEC) != 0) {
+        return DataTransfer::read(-1, device, this);
+    }
+    receive(mimeType, pipeFds[1]);
+    close(pipeFds[1]);
+    // the source only starts writing once it got the request
+    wl_display_flush(wl_proxy_get_display(d->dataOffer));
+    return DataTransfer::read(pipeFds[0], device, this);
+}
+
 DataOffer::operator wl_data_offer *()
 {
     return d->dataOffer;
@@ -14,6 +14,7 @@
 
 struct wl_data_offer;
 
+class QIODevice;
 class QMimeType;
 
 namespace KWayland
@@ -21,6 +22,7 @@ namespace KWayland
 namespace Client
 {
 class DataDevice;
+class DataTransfer;
 
 /**
  * @short Wrapper for the wl_data_offer interface.
@@ -62,7 +64,19 @@ public:
      **/
     bool isValid() const;
 
+    /**
+     * @returns The offered mime types known to the QMimeDatabase.
+     * The mime types are resolved on the first call after new ones got offered.
+     * @see offeredMimeTypeNames
+     **/
     QList<QMimeType> offeredMimeTypes() const;
+    /**
+     * @returns The names of all offered mime types as sent by the DataSource, including the
+     * ones unknown to the QMimeDatabase. Does not resolve the mime types.
+     * @see offeredMimeTypes
+     * @since 6.7
+     **/
+    QStringList offeredMimeTypeNames() const;
 
     /**
      * Indicates that the client can accept data of the given @a mimeType.
@@ -83,6 +97,15 @@ public:
 
     void receive(const QMimeType &mimeType, qint32 fd);
     void receive(const QString &mimeType, qint32 fd);
+    /**
+     * Requests the data for @p mimeType and returns a DataTransfer streaming it without
+     * blocking. If @p device is not @c null the data is written to it, otherwise it can be
+     * accessed through the DataTransfer. The DataTransfer is owned by this DataOffer.
+     *
+     * @see DataTransfer::read
+     * @since 6.7
+     **/
+    DataTransfer *receiveData(const QString &mimeType, QIODevice *device = nullptr);
 
     /**
      * Notifies the compositor that the drag destination successfully
@@ -118,6 +141,10 @@ public:
     operator wl_data_offer *() const;
 
 Q_SIGNALS:
+    /**
+     * Emitted for every offered mime type known to the QMimeDatabase with its canonical name.
+     * The mime types only get resolved on offer if this signal is connected.
+     **/
     void mimeTypeOffered(const QString &);
     /**
      * Emitted whenever the @link{sourceDragAndDropActions} changed, e.g. on enter or when
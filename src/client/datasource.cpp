@@ -4,6 +4,7 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
 */
 #include "datasource.h"
+#include "datatransfer.h"
 #include "wayland_pointer_p.h"
 // Qt
 #include <QMimeType>
@@ -155,6 +156,16 @@ void DataSource::offer(const QString &mimeType)
     wl_data_source_offer(d->source, mimeType.toUtf8().constData());
 }
 
+DataTransfer *DataSource::sendData(qint32 fd, const QByteArray &data)
+{
+    return DataTransfer::write(fd, data, this);
+}
+
+DataTransfer *DataSource::sendData(qint32 fd, QIODevice *device)
+{
+    return DataTransfer::write(fd, device, this);
+}
+
 void DataSource::offer(const QMimeType &mimeType)
 {
     if (!mimeType.isValid()) {
@@ -14,12 +14,15 @@
 #include "KWayland/Client/kwaylandclient_export.h"
 
 struct wl_data_source;
+class QIODevice;
 class QMimeType;
 
 namespace KWayland
 {
 namespace Client
 {
+class DataTransfer;
+
 /**
  * @short Wrapper for the wl_data_source interface.
  *
@@ -70,6 +73,24 @@ public:
     void offer(const QString &mimeType);
     void offer(const QMimeType &mimeType);
 
+    /**
+     * Writes @p data to @p fd without blocking, usually in response to sendDataRequested.
+     * The returned DataTransfer takes ownership of @p fd and is owned by this DataSource.
+     *
+     * @see DataTransfer::write
+     * @since 6.7
+     **/
+    DataTransfer *sendData(qint32 fd, const QByteArray &data);
+    /**
+     * Writes the content of @p device to @p fd without blocking, usually in response to
+     * sendDataRequested. The content of a file is written without copying it through the
+     * process. The returned DataTransfer takes ownership of @p fd and is owned by this DataSource.
+     *
+     * @see DataTransfer::write
+     * @since 6.7
+     **/
+    DataTransfer *sendData(qint32 fd, QIODevice *device);
+
     /**
      * Sets the actions that the source side client supports for this
      * operation.
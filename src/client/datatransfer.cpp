@@ -0,0 +1,402 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "datatransfer.h"
+// Qt
+#include <QFileDevice>
+#include <QIODevice>
+#include <QPointer>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <qplatformdefs.h>
+// system
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <memory>
+#include <pthread.h>
+#ifdef Q_OS_LINUX
+#include <sys/sendfile.h>
+#endif
+
+namespace KWayland
+{
+namespace Client
+{
+class Q_DECL_HIDDEN DataTransfer::Private
+{
+public:
+    Private(DataTransfer *q, qint32 fd, bool reading);
+    ~Private();
+
+    enum class Result {
+        Continue,
+        Wait,
+        Done,
+        Error,
+    };
+
+    void setupDevice(QIODevice *device);
+    void transfer();
+    Result readChunk();
+    Result writeChunk();
+    void finish(State state);
+    void restartTimer();
+
+    int fd;
+    const bool reading;
+    State state = State::Running;
+    QPointer<QIODevice> device;
+    // the received data or the data to write
+    QByteArray data;
+    qint64 dataOffset = 0;
+    // the file descriptor of a file-backed device, written with sendfile
+    int fileFd = -1;
+    qint64 fileOffset = 0;
+    bool deviceFinished = false;
+    std::function<void(const QByteArray &)> chunkHandler;
+    qint64 chunkSize = 64 * 1024;
+    int timeout = 30000;
+    qint64 transferred = 0;
+    qint64 total = -1;
+    std::unique_ptr<QSocketNotifier> notifier;
+    QTimer *timer;
+
+private:
+    DataTransfer *q;
+};
+
+// upper bound of chunks per activation, so that one transfer does not starve the event loop
+static const int s_maximumChunksPerActivation = 16;
+
+DataTransfer::Private::Private(DataTransfer *q, qint32 fd, bool reading)
+    : fd(fd)
+    , reading(reading)
+    , timer(new QTimer(q))
+    , q(q)
+{
+    timer->setSingleShot(true);
+    QObject::connect(timer, &QTimer::timeout, q, [this] {
+        finish(State::TimedOut);
+    });
+    if (fd < 0) {
+        QMetaObject::invokeMethod(
+            q,
+            [this] {
+                finish(State::Failed);
+            },
+            Qt::QueuedConnection);
+        return;
+    }
+    // the file descriptors passed by the compositor might be blocking
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    notifier.reset(new QSocketNotifier(fd, reading ? QSocketNotifier::Read : QSocketNotifier::Write));
+    QObject::connect(notifier.get(), &QSocketNotifier::activated, q, [this] {
+        transfer();
+    });
+    restartTimer();
+}
+
+DataTransfer::Private::~Private()
+{
+    if (fd >= 0) {
+        notifier.reset();
+        close(fd);
+    }
+}
+
+void DataTransfer::Private::setupDevice(QIODevice *device)
+{
+    this->device = device;
+    if (!device || reading) {
+        return;
+    }
+#ifdef Q_OS_LINUX
+    auto file = qobject_cast<QFileDevice *>(device);
+    if (file && !file->isSequential() && file->handle() >= 0) {
+        fileFd = file->handle();
+        fileOffset = file->pos();
+        total = file->size() - fileOffset;
+        return;
+    }
+#endif
+    if (device->isSequential()) {
+        // wait for more data once everything available is written
+        QObject::connect(device, &QIODevice::readyRead, q, [this] {
+            if (notifier) {
+                notifier->setEnabled(true);
+            }
+        });
+        QObject::connect(device, &QIODevice::readChannelFinished, q, [this] {
+            deviceFinished = true;
+            if (notifier) {
+                notifier->setEnabled(true);
+            }
+        });
+    } else {
+        total = device->size() - device->pos();
+    }
+}
+
+void DataTransfer::Private::transfer()
+{
+    // don't get killed if the reader closed the pipe. The disposition of SIGPIPE is process wide,
+    // so instead of ignoring it the signal is blocked for this thread and a raised one is drained.
+    sigset_t pipeSignal;
+    sigset_t oldMask;
+    bool wasPending = false;
+    if (!reading) {
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, &oldMask);
+        sigset_t pending;
+        sigpending(&pending);
+        wasPending = sigismember(&pending, SIGPIPE);
+    }
+
+    const qint64 previouslyTransferred = transferred;
+    Result result = Result::Continue;
+    for (int i = 0; i < s_maximumChunksPerActivation && result == Result::Continue; ++i) {
+        result = reading ? readChunk() : writeChunk();
+    }
+
+    if (!reading) {
+        sigset_t pending;
+        sigpending(&pending);
+        if (!wasPending && sigismember(&pending, SIGPIPE)) {
+            const struct timespec noWait = {0, 0};
+            while (sigtimedwait(&pipeSignal, nullptr, &noWait) < 0 && errno == EINTR) { }
+        }
+        pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+    }
+
+    if (transferred != previouslyTransferred) {
+        restartTimer();
+        QPointer<DataTransfer> guard(q);
+        Q_EMIT q->progress(transferred, total);
+        if (!guard) {
+            return;
+        }
+    }
+    if (result == Result::Done) {
+        finish(State::Finished);
+    } else if (result == Result::Error) {
+        finish(State::Failed);
+    }
+}
+
+DataTransfer::Private::Result DataTransfer::Private::readChunk()
+{
+    // without device and chunk handler the data is read directly into data, dataOffset is its size
+    const bool collect = !device && !chunkHandler;
+    QByteArray buffer;
+    char *target;
+    if (collect) {
+        data.resize(dataOffset + chunkSize);
+        target = data.data() + dataOffset;
+    } else {
+        buffer.resize(chunkSize);
+        target = buffer.data();
+    }
+    const qint64 n = QT_READ(fd, target, chunkSize);
+    const int error = errno;
+    if (collect) {
+        dataOffset += qMax(qint64(0), n);
+        data.resize(dataOffset);
+    }
+    if (n < 0) {
+        if (error == EINTR) {
+            return Result::Continue;
+        }
+        return error == EAGAIN ? Result::Wait : Result::Error;
+    }
+    if (n == 0) {
+        return Result::Done;
+    }
+    transferred += n;
+    if (!collect) {
+        buffer.resize(n);
+        if (device) {
+            if (device->write(buffer) != n) {
+                return Result::Error;
+            }
+        } else {
+            chunkHandler(buffer);
+        }
+    }
+    return Result::Continue;
+}
+
+DataTransfer::Private::Result DataTransfer::Private::writeChunk()
+{
+#ifdef Q_OS_LINUX
+    if (fileFd >= 0) {
+        const qint64 count = qMin(chunkSize, total - transferred);
+        if (count <= 0) {
+            return Result::Done;
+        }
+        off_t offset = fileOffset;
+        const qint64 n = sendfile(fd, fileFd, &offset, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                return Result::Continue;
+            }
+            return errno == EAGAIN ? Result::Wait : Result::Error;
+        }
+        if (n == 0) {
+            // the file got truncated
+            return Result::Done;
+        }
+        fileOffset = offset;
+        transferred += n;
+        return Result::Continue;
+    }
+#endif
+    if (dataOffset == data.size()) {
+        if (!device) {
+            return Result::Done;
+        }
+        data = device->read(chunkSize);
+        dataOffset = 0;
+        if (data.isEmpty()) {
+            if (!device->isSequential() || deviceFinished || !device->isOpen()) {
+                return Result::Done;
+            }
+            // continued on readyRead
+            notifier->setEnabled(false);
+            return Result::Wait;
+        }
+    }
+    const qint64 n = QT_WRITE(fd, data.constData() + dataOffset, qMin(chunkSize, data.size() - dataOffset));
+    if (n < 0) {
+        if (errno == EINTR) {
+            return Result::Continue;
+        }
+        return errno == EAGAIN ? Result::Wait : Result::Error;
+    }
+    dataOffset += n;
+    transferred += n;
+    return Result::Continue;
+}
+
+void DataTransfer::Private::finish(State state)
+{
+    if (this->state != State::Running) {
+        return;
+    }
+    this->state = state;
+    timer->stop();
+    if (notifier) {
+        // might be called from the activated signal of the notifier
+        notifier->setEnabled(false);
+        notifier.release()->deleteLater();
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (fileFd >= 0 && device) {
+        device->seek(fileOffset);
+    }
+    if (!reading) {
+        data.clear();
+    }
+    Q_EMIT q->finished();
+}
+
+void DataTransfer::Private::restartTimer()
+{
+    if (timeout > 0 && state == State::Running) {
+        timer->start(timeout);
+    } else {
+        timer->stop();
+    }
+}
+
+DataTransfer::DataTransfer(qint32 fd, bool reading, QObject *parent)
+    : QObject(parent)
+    , d(new Private(this, fd, reading))
+{
+}
+
+DataTransfer::~DataTransfer() = default;
+
+DataTransfer *DataTransfer::read(qint32 fd, QIODevice *device, QObject *parent)
+{
+    DataTransfer *transfer = new DataTransfer(fd, true, parent);
+    transfer->d->setupDevice(device);
+    return transfer;
+}
+
+DataTransfer *DataTransfer::write(qint32 fd, const QByteArray &data, QObject *parent)
+{
+    DataTransfer *transfer = new DataTransfer(fd, false, parent);
+    transfer->d->data = data;
+    transfer->d->total = data.size();
+    return transfer;
+}
+
+DataTransfer *DataTransfer::write(qint32 fd, QIODevice *device, QObject *parent)
+{
+    DataTransfer *transfer = new DataTransfer(fd, false, parent);
+    transfer->d->setupDevice(device);
+    return transfer;
+}
+
+void DataTransfer::setChunkHandler(const std::function<void(const QByteArray &chunk)> &handler)
+{
+    d->chunkHandler = handler;
+}
+
+void DataTransfer::setChunkSize(qint64 size)
+{
+    d->chunkSize = qMax(qint64(1), size);
+}
+
+qint64 DataTransfer::chunkSize() const
+{
+    return d->chunkSize;
+}
+
+void DataTransfer::setTimeout(int timeout)
+{
+    d->timeout = qMax(0, timeout);
+    d->restartTimer();
+}
+
+int DataTransfer::timeout() const
+{
+    return d->timeout;
+}
+
+void DataTransfer::cancel()
+{
+    d->finish(State::Cancelled);
+}
+
+DataTransfer::State DataTransfer::state() const
+{
+    return d->state;
+}
+
+qint64 DataTransfer::bytesTransferred() const
+{
+    return d->transferred;
+}
+
+qint64 DataTransfer::bytesTotal() const
+{
+    return d->total;
+}
+
+QByteArray DataTransfer::data() const
+{
+    return d->reading ? d->data : QByteArray();
+}
+
+}
+}
+
+#include "moc_datatransfer.cpp"
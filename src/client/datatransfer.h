@@ -0,0 +1,159 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#ifndef WAYLAND_DATATRANSFER_H
+#define WAYLAND_DATATRANSFER_H
+
+#include <QObject>
+
+#include "KWayland/Client/kwaylandclient_export.h"
+
+#include <functional>
+
+class QIODevice;
+
+namespace KWayland
+{
+namespace Client
+{
+/**
+ * @short Streams clipboard and drag and drop data through a pipe without blocking.
+ *
+ * The data of a DataOffer or a DataSource is exchanged through the file descriptor of a pipe.
+ * A DataTransfer reads from or writes to such a file descriptor in chunks whenever the pipe is
+ * ready, driven by the event loop of the thread it lives in. Thus the transfer neither blocks
+ * nor needs a thread, and large payloads do not need to be kept in memory at once.
+ *
+ * A reading DataTransfer, e.g. created by DataOffer::receiveData, passes the received chunks
+ * to a QIODevice, to a chunk handler or collects them in data:
+ *
+ * @code
+ * DataTransfer *transfer = offer->receiveData(QStringLiteral("text/plain"));
+ * connect(transfer, &DataTransfer::finished, transfer, [transfer] {
+ *     if (transfer->state() == DataTransfer::State::Finished) {
+ *         qDebug() << transfer->data();
+ *     }
+ *     transfer->deleteLater();
+ * });
+ * @endcode
+ *
+ * A writing DataTransfer, e.g. created by DataSource::sendData, writes a QByteArray or the
+ * content of a QIODevice. The content of a file is written with sendfile, without copying
+ * it through the process.
+ *
+ * A DataTransfer takes ownership of the file descriptor and closes it once the transfer ended.
+ *
+ * @since 6.7
+ **/
+class KWAYLANDCLIENT_EXPORT DataTransfer : public QObject
+{
+    Q_OBJECT
+public:
+    enum class State {
+        /**
+         * The transfer is in progress.
+         **/
+        Running,
+        /**
+         * All data got transferred.
+         **/
+        Finished,
+        /**
+         * The transfer got cancelled with cancel.
+         **/
+        Cancelled,
+        /**
+         * No data could be transferred within the timeout.
+         **/
+        TimedOut,
+        /**
+         * Reading or writing failed, e.g. because the other side closed the pipe.
+         **/
+        Failed,
+    };
+    Q_ENUM(State)
+    ~DataTransfer() override;
+
+    /**
+     * Creates a DataTransfer reading from @p fd until the writing side closes the pipe.
+     * If @p device is not @c null the received data is written to it, the @p device
+     * needs to stay open during the transfer.
+     **/
+    static DataTransfer *read(qint32 fd, QIODevice *device = nullptr, QObject *parent = nullptr);
+    /**
+     * Creates a DataTransfer writing @p data to @p fd.
+     **/
+    static DataTransfer *write(qint32 fd, const QByteArray &data, QObject *parent = nullptr);
+    /**
+     * Creates a DataTransfer writing the content of @p device from its current position to
+     * @p fd. The @p device needs to stay open during the transfer.
+     **/
+    static DataTransfer *write(qint32 fd, QIODevice *device, QObject *parent = nullptr);
+
+    /**
+     * Sets the @p handler which is invoked for every received chunk instead of collecting the
+     * data. Only applies to a reading DataTransfer without device.
+     **/
+    void setChunkHandler(const std::function<void(const QByteArray &chunk)> &handler);
+    /**
+     * Sets the maximum @p size of a single read or write. The default is 64 KiB.
+     **/
+    void setChunkSize(qint64 size);
+    /**
+     * @returns the maximum size of a single read or write
+     **/
+    qint64 chunkSize() const;
+    /**
+     * Sets the @p timeout in milliseconds after which the transfer is aborted if no data could
+     * be transferred. The default is @c 30000, @c 0 disables the timeout.
+     **/
+    void setTimeout(int timeout);
+    /**
+     * @returns the timeout in milliseconds, @c 0 if disabled
+     **/
+    int timeout() const;
+
+    /**
+     * Aborts the transfer and closes the file descriptor.
+     **/
+    void cancel();
+
+    /**
+     * @returns the state of the transfer
+     **/
+    State state() const;
+    /**
+     * @returns the number of bytes read or written so far
+     **/
+    qint64 bytesTransferred() const;
+    /**
+     * @returns the number of bytes to write or @c -1 if unknown, e.g. for reading
+     **/
+    qint64 bytesTotal() const;
+    /**
+     * @returns the data received by a reading DataTransfer without device and chunk handler
+     **/
+    QByteArray data() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted whenever data got transferred.
+     **/
+    void progress(qint64 bytesTransferred, qint64 bytesTotal);
+    /**
+     * Emitted once the transfer ended, state tells whether it succeeded.
+     **/
+    void finished();
+
+private:
+    explicit DataTransfer(qint32 fd, bool reading, QObject *parent);
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+}
+}
+
+#endif
@@ -6,9 +6,15 @@
 #include "event_queue.h"
 #include "connection_thread.h"
 #include "wayland_pointer_p.h"
+// Qt
+#include <QPointer>
+#include <QSocketNotifier>
 
 #include <wayland-client.h>
 
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 namespace KWayland
 {
 namespace Client
@@ -16,10 +22,30 @@ namespace Client
 class Q_DECL_HIDDEN EventQueue::Private
 {
 public:
+    void releaseNotifier();
+
     wl_display *display = nullptr;
     WaylandPointer<wl_event_queue, wl_event_queue_destroy> queue;
+    // only used if the connection has a dedicated reader thread
+    QPointer<ConnectionThread> connection;
+    int notifierFd = -1;
+    QScopedPointer<QSocketNotifier> notifier;
 };
 
+void EventQueue::Private::releaseNotifier()
+{
+    if (notifierFd == -1) {
+        return;
+    }
+    if (connection) {
+        connection->unregisterQueueNotifier(notifierFd);
+    }
+    connection.clear();
+    notifier.reset();
+    close(notifierFd);
+    notifierFd = -1;
+}
+
 EventQueue::EventQueue(QObject *parent)
     : QObject(parent)
     , d(new Private)
@@ -33,12 +59,14 @@ EventQueue::~EventQueue()
 
 void EventQueue::release()
 {
+    d->releaseNotifier();
     d->queue.release();
     d->display = nullptr;
 }
 
 void EventQueue::destroy()
 {
+    d->releaseNotifier();
     d->queue.destroy();
     d->display = nullptr;
 }
@@ -60,6 +88,20 @@ void EventQueue::setup(wl_display *display)
 void EventQueue::setup(ConnectionThread *connection)
 {
     setup(connection->display());
+    if (connection->hasDedicatedReaderThread()) {
+        d->notifierFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (d->notifierFd != -1) {
+            d->notifier.reset(new QSocketNotifier(d->notifierFd, QSocketNotifier::Read));
+            connect(d->notifier.data(), &QSocketNotifier::activated, this, [this] {
+                eventfd_t value;
+                eventfd_read(d->notifierFd, &value);
+                dispatch();
+            });
+            d->connection = connection;
+            connection->registerQueueNotifier(d->notifierFd);
+            return;
+        }
+    }
     connect(connection, &ConnectionThread::eventsRead, this, &EventQueue::dispatch, Qt::QueuedConnection);
 }
 
@@ -73,7 +73,12 @@ public:
      * This method also connects the eventsRead signal of the ConnectionThread
      * to the dispatch method. Events will be automatically dispatched without
      * the need to call dispatch manually.
+     *
+     * If the @p connection uses a dedicated reader thread the EventQueue is woken
+     * up directly by the reader thread through an eventfd instead of the eventsRead
+     * signal. The EventQueue must be set up from the thread it is dispatched in.
      * @see dispatch
+     * @see ConnectionThread::setDedicatedReaderThread
      **/
     void setup(ConnectionThread *connection);
 
@@ -6,14 +6,140 @@
 #include "keyboard.h"
 #include "surface.h"
 #include "wayland_pointer_p.h"
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLibrary>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPointer>
+#include <QTimer>
 // wayland
 #include <wayland-client-protocol.h>
+// system
+#include <memory>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
 
 namespace KWayland
 {
 namespace Client
 {
+/**
+ * A keymap compiled with libxkbcommon, shared by all Keyboards with the same keymap.
+ **/
+struct Q_DECL_HIDDEN CompiledKeymap {
+    ~CompiledKeymap();
+    QByteArray text;
+    QByteArray hash;
+    xkb_keymap *keymap = nullptr;
+};
+
+/**
+ * Process wide cache of the compiled keymaps by the hash of their text. The cache only holds
+ * weak references, a keymap is released once no Keyboard uses it anymore.
+ *
+ * libxkbcommon is loaded on first use, so that clients not interested in the keymap do not
+ * depend on it.
+ **/
+class Q_DECL_HIDDEN KeymapCache
+{
+public:
+    std::shared_ptr<CompiledKeymap> keymap(const QByteArray &hash, const char *text, qsizetype size);
+    void unref(xkb_keymap *keymap);
+    bool keyRepeats(xkb_keymap *keymap, quint32 key);
+
+private:
+    bool loadXkbCommon();
+
+    // the subset of libxkbcommon in use
+    struct {
+        void *(*contextNew)(int flags) = nullptr;
+        xkb_keymap *(*keymapNewFromBuffer)(void *context, const char *buffer, size_t length, int format, int flags) = nullptr;
+        void (*keymapUnref)(xkb_keymap *keymap) = nullptr;
+        int (*keymapKeyRepeats)(xkb_keymap *keymap, quint32 key) = nullptr;
+    } xkb;
+    bool xkbLoaded = false;
+    void *context = nullptr;
+    QMutex mutex;
+    QHash<QByteArray, std::weak_ptr<CompiledKeymap>> keymaps;
+};
+
+Q_GLOBAL_STATIC(KeymapCache, s_keymapCache)
+
+CompiledKeymap::~CompiledKeymap()
+{
+    if (keymap && s_keymapCache.exists()) {
+        s_keymapCache->unref(keymap);
+    }
+}
+
+bool KeymapCache::loadXkbCommon()
+{
+    if (xkbLoaded) {
+        return context;
+    }
+    xkbLoaded = true;
+    QLibrary library(QStringLiteral("xkbcommon"), 0);
+    if (!library.load()) {
+        return false;
+    }
+    xkb.contextNew = reinterpret_cast<decltype(xkb.contextNew)>(library.resolve("xkb_context_new"));
+    xkb.keymapNewFromBuffer = reinterpret_cast<decltype(xkb.keymapNewFromBuffer)>(library.resolve("xkb_keymap_new_from_buffer"));
+    xkb.keymapUnref = reinterpret_cast<decltype(xkb.keymapUnref)>(library.resolve("xkb_keymap_unref"));
+    xkb.keymapKeyRepeats = reinterpret_cast<decltype(xkb.keymapKeyRepeats)>(library.resolve("xkb_keymap_key_repeats"));
+    if (!xkb.contextNew || !xkb.keymapNewFromBuffer || !xkb.keymapUnref) {
+        return false;
+    }
+    // XKB_CONTEXT_NO_FLAGS
+    context = xkb.contextNew(0);
+    return context;
+}
+
+std::shared_ptr<CompiledKeymap> KeymapCache::keymap(const QByteArray &hash, const char *text, qsizetype size)
+{
+    QMutexLocker lock(&mutex);
+    if (std::shared_ptr<CompiledKeymap> keymap = keymaps.value(hash).lock()) {
+        return keymap;
+    }
+    // drop the released keymaps
+    for (auto it = keymaps.begin(); it != keymaps.end();) {
+        if (it->expired()) {
+            it = keymaps.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto keymap = std::make_shared<CompiledKeymap>();
+    // the text is null terminated
+    keymap->text = QByteArray(text, qstrnlen(text, size));
+    keymap->hash = hash;
+    if (loadXkbCommon()) {
+        // XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS
+        keymap->keymap = xkb.keymapNewFromBuffer(context, keymap->text.constData(), keymap->text.size(), 1, 0);
+    }
+    keymaps.insert(hash, keymap);
+    return keymap;
+}
+
+void KeymapCache::unref(xkb_keymap *keymap)
+{
+    QMutexLocker lock(&mutex);
+    xkb.keymapUnref(keymap);
+}
+
+bool KeymapCache::keyRepeats(xkb_keymap *keymap, quint32 key)
+{
+    QMutexLocker lock(&mutex);
+    if (!xkb.keymapKeyRepeats) {
+        return true;
+    }
+    // xkb keycodes are offset by 8 to evdev keycodes
+    return xkb.keymapKeyRepeats(keymap, key + 8);
+}
+
 class Q_DECL_HIDDEN Keyboard::Private
 {
 public:
@@ -29,7 +155,34 @@ public:
         qint32 delay = 0;
     } repeatInfo;
 
+    bool keymapLoadingEnabled = false;
+    std::shared_ptr<CompiledKeymap> keymap;
+
+    struct {
+        bool enabled = false;
+        quint32 key = 0;
+        // timestamp of the press
+        quint32 time = 0;
+        // started on dispatching the press, invalid while no key repeats
+        QElapsedTimer clock;
+        // time in milliseconds from the press to its dispatch
+        qint64 latency = 0;
+        qint64 repeats = 0;
+        QTimer *timer = nullptr;
+    } repeat;
+    struct {
+        quint32 depressed = 0;
+        quint32 latched = 0;
+        quint32 locked = 0;
+        quint32 group = 0;
+    } modifiers;
+
+    void startRepeat(quint32 key, quint32 time);
+    void stopRepeat();
+    void emitRepeats();
+
 private:
+    void loadKeymap(int fd, uint32_t size);
     void enter(uint32_t serial, wl_surface *surface, wl_array *keys);
     void leave(uint32_t serial);
     static void keymapCallback(void *data, wl_keyboard *keyboard, uint32_t format, int fd, uint32_t size);
@@ -71,11 +224,13 @@ Keyboard::~Keyboard()
 
 void Keyboard::release()
 {
+    d->stopRepeat();
     d->keyboard.release();
 }
 
 void Keyboard::destroy()
 {
+    d->stopRepeat();
     d->keyboard.destroy();
 }
 
@@ -113,6 +268,7 @@ void Keyboard::Private::leaveCallback(void *data, wl_keyboard *keyboard, uint32_
 
 void Keyboard::Private::leave(uint32_t serial)
 {
+    stopRepeat();
     enteredSurface.clear();
     Q_EMIT q->left(serial);
 }
@@ -129,7 +285,99 @@ void Keyboard::Private::keyCallback(void *data, wl_keyboard *keyboard, uint32_t
             return KeyState::Pressed;
         }
     };
+    QPointer<Keyboard> guard(k->q);
     Q_EMIT k->q->keyChanged(key, toState(), time);
+    if (!guard || !k->repeat.enabled) {
+        return;
+    }
+    if (toState() == KeyState::Pressed) {
+        k->startRepeat(key, time);
+    } else if (key == k->repeat.key) {
+        k->stopRepeat();
+    }
+}
+
+// upper bound of repeats emitted at once, e.g. after the process got suspended
+static const qint64 s_maximumBatchedRepeats = 8;
+// a larger difference between a timestamp and the monotonic clock means they don't share a base
+static const qint64 s_maximumPressLatency = 1000;
+
+// the time of the press in milliseconds before now, compositors use CLOCK_MONOTONIC for the
+// timestamps in practice although the protocol leaves the base undefined
+static qint64 pressLatency(quint32 time)
+{
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+        return 0;
+    }
+    const quint32 nowMsec = quint32(qint64(now.tv_sec) * 1000 + now.tv_nsec / 1000000);
+    const qint64 latency = qint32(nowMsec - time);
+    return latency >= 0 && latency <= s_maximumPressLatency ? latency : 0;
+}
+
+void Keyboard::Private::startRepeat(quint32 key, quint32 time)
+{
+    stopRepeat();
+    if (repeatInfo.charactersPerSecond <= 0) {
+        return;
+    }
+    if (keymap && keymap->keymap && !s_keymapCache->keyRepeats(keymap->keymap, key)) {
+        return;
+    }
+    repeat.key = key;
+    repeat.time = time;
+    repeat.repeats = 0;
+    repeat.clock.start();
+    // schedule from the press, not from its dispatch
+    repeat.latency = pressLatency(time);
+    repeat.timer->start(qMax(qint64(0), repeatInfo.delay - repeat.latency));
+}
+
+void Keyboard::Private::stopRepeat()
+{
+    repeat.clock.invalidate();
+    if (repeat.timer) {
+        repeat.timer->stop();
+    }
+}
+
+void Keyboard::Private::emitRepeats()
+{
+    if (!repeat.clock.isValid() || repeatInfo.charactersPerSecond <= 0) {
+        return;
+    }
+    const qint64 delay = repeatInfo.delay;
+    const qint64 rate = repeatInfo.charactersPerSecond;
+    // the n-th repeat is due at delay + n * 1000 / rate milliseconds after the press
+    auto dueTime = [delay, rate](qint64 repeat) {
+        return delay + repeat * 1000 / rate;
+    };
+    const qint64 elapsed = repeat.clock.elapsed() + repeat.latency;
+    // the number of due repeats, estimated and then corrected to the rounding of dueTime
+    qint64 due = elapsed < delay ? 0 : (elapsed - delay) * rate / 1000 + 1;
+    while (due > 0 && dueTime(due - 1) > elapsed) {
+        --due;
+    }
+    while (dueTime(due) <= elapsed) {
+        ++due;
+    }
+    if (due - repeat.repeats > s_maximumBatchedRepeats) {
+        repeat.repeats = due - s_maximumBatchedRepeats;
+    }
+
+    QPointer<Keyboard> guard(q);
+    const quint32 key = repeat.key;
+    while (repeat.repeats < due) {
+        const quint32 time = repeat.time + dueTime(repeat.repeats);
+        ++repeat.repeats;
+        Q_EMIT q->keyChanged(key, KeyState::Pressed, time);
+        if (!guard || !repeat.clock.isValid() || repeat.key != key) {
+            // deleted or stopped meanwhile
+            return;
+        }
+    }
+    // the next repeat is not due yet, so don't spin on zero timeouts
+    repeat.timer->start(qMax(qint64(1), dueTime(repeat.repeats) - repeat.clock.elapsed() - repeat.latency));
 }
 
 void Keyboard::Private::keymapCallback(void *data, wl_keyboard *keyboard, uint32_t format, int fd, uint32_t size)
@@ -139,9 +387,31 @@ void Keyboard::Private::keymapCallback(void *data, wl_keyboard *keyboard, uint32
     if (format != WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1) {
         return;
     }
+    if (k->keymapLoadingEnabled) {
+        k->loadKeymap(fd, size);
+        return;
+    }
     Q_EMIT k->q->keymapChanged(fd, size);
 }
 
+void Keyboard::Private::loadKeymap(int fd, uint32_t size)
+{
+    void *map = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        return;
+    }
+    const char *text = static_cast<const char *>(map);
+    const QByteArray hash = QCryptographicHash::hash(QByteArrayView(text, size), QCryptographicHash::Sha1);
+    if (keymap && keymap->hash == hash) {
+        munmap(map, size);
+        return;
+    }
+    keymap = s_keymapCache->keymap(hash, text, size);
+    munmap(map, size);
+    Q_EMIT q->keymapLoaded();
+}
+
 void Keyboard::Private::modifiersCallback(void *data,
                                           wl_keyboard *keyboard,
                                           uint32_t serial,
@@ -153,6 +423,10 @@ void Keyboard::Private::modifiersCallback(void *data,
     Q_UNUSED(serial)
     auto k = reinterpret_cast<Keyboard::Private *>(data);
     Q_ASSERT(k->keyboard == keyboard);
+    if (k->modifiers.depressed != modsDepressed || k->modifiers.latched != modsLatched || k->modifiers.locked != modsLocked || k->modifiers.group != group) {
+        k->modifiers = {modsDepressed, modsLatched, modsLocked, group};
+        k->stopRepeat();
+    }
     Q_EMIT k->q->modifiersChanged(modsDepressed, modsLatched, modsLocked, group);
 }
 
@@ -162,6 +436,7 @@ void Keyboard::Private::repeatInfoCallback(void *data, wl_keyboard *keyboard, in
     Q_ASSERT(k->keyboard == keyboard);
     k->repeatInfo.charactersPerSecond = qMax(charactersPerSecond, 0);
     k->repeatInfo.delay = qMax(delay, 0);
+    k->stopRepeat();
     Q_EMIT k->q->keyRepeatChanged();
 }
 
@@ -200,6 +475,51 @@ qint32 Keyboard::keyRepeatRate() const
     return d->repeatInfo.charactersPerSecond;
 }
 
+void Keyboard::setKeyRepeatEmulationEnabled(bool enabled)
+{
+    d->repeat.enabled = enabled;
+    if (!enabled) {
+        d->stopRepeat();
+        return;
+    }
+    if (!d->repeat.timer) {
+        d->repeat.timer = new QTimer(this);
+        d->repeat.timer->setSingleShot(true);
+        d->repeat.timer->setTimerType(Qt::PreciseTimer);
+        connect(d->repeat.timer, &QTimer::timeout, this, [this] {
+            d->emitRepeats();
+        });
+    }
+}
+
+bool Keyboard::isKeyRepeatEmulationEnabled() const
+{
+    return d->repeat.enabled;
+}
+
+void Keyboard::setKeymapLoadingEnabled(bool enabled)
+{
+    d->keymapLoadingEnabled = enabled;
+    if (!enabled) {
+        d->keymap.reset();
+    }
+}
+
+bool Keyboard::isKeymapLoadingEnabled() const
+{
+    return d->keymapLoadingEnabled;
+}
+
+QByteArray Keyboard::keymap() const
+{
+    return d->keymap ? d->keymap->text : QByteArray();
+}
+
+xkb_keymap *Keyboard::xkbKeymap() const
+{
+    return d->keymap ? d->keymap->keymap : nullptr;
+}
+
 Keyboard::operator wl_keyboard *()
 {
     return d->keyboard;
@@ -11,6 +11,7 @@
 #include "KWayland/Client/kwaylandclient_export.h"
 
 struct wl_keyboard;
+struct xkb_keymap;
 
 namespace KWayland
 {
@@ -112,6 +113,72 @@ public:
      **/
     qint32 keyRepeatDelay() const;
 
+    /**
+     * Enables synthesizing key repeat in the Keyboard.
+     *
+     * While a key is held down keyChanged is emitted with KeyState::Pressed repeatedly
+     * according to keyRepeatDelay and keyRepeatRate. The repeats are scheduled relative to
+     * the timestamp of the press, a press dispatched late or a repeat firing late does not delay
+     * the following ones and repeats missed meanwhile are emitted at once. The timestamps of the
+     * repeats are derived from the timestamp of the press. If the timestamps of the compositor
+     * are not based on CLOCK_MONOTONIC, the repeats are scheduled relative to the dispatch of
+     * the press instead. Repeating stops when the key gets released, another key gets
+     * pressed, the modifiers change or the Keyboard loses focus.
+     *
+     * If keymap loading is enabled keys which should not repeat according to the keymap,
+     * like modifiers, are not repeated.
+     *
+     * Disabled by default.
+     * @see isKeyRepeatEnabled
+     * @see setKeymapLoadingEnabled
+     * @since 6.7
+     **/
+    void setKeyRepeatEmulationEnabled(bool enabled);
+    /**
+     * @returns whether the Keyboard synthesizes key repeat
+     * @see setKeyRepeatEmulationEnabled
+     * @since 6.7
+     **/
+    bool isKeyRepeatEmulationEnabled() const;
+
+    /**
+     * Enables loading the keymap in the Keyboard instead of emitting keymapChanged.
+     *
+     * The Keyboard maps the keymap read-only and hashes its content. If the content differs
+     * from the current keymap it gets compiled with libxkbcommon, which is loaded on first use,
+     * and keymapLoaded is emitted. Compiled keymaps are shared by all Keyboards of the process
+     * with the same keymap, thus repeated keymap events with identical content neither copy
+     * nor compile the keymap again.
+     *
+     * Disabled by default.
+     * @see keymap
+     * @see xkbKeymap
+     * @see keymapLoaded
+     * @since 6.7
+     **/
+    void setKeymapLoadingEnabled(bool enabled);
+    /**
+     * @returns whether the Keyboard loads the keymap itself
+     * @see setKeymapLoadingEnabled
+     * @since 6.7
+     **/
+    bool isKeymapLoadingEnabled() const;
+    /**
+     * @returns The text of the current keymap or an empty QByteArray if keymap loading is
+     * disabled or no keymap got received yet.
+     * @see setKeymapLoadingEnabled
+     * @since 6.7
+     **/
+    QByteArray keymap() const;
+    /**
+     * @returns The compiled current keymap or @c nullptr if keymap loading is disabled,
+     * libxkbcommon is not available or the keymap could not be compiled. The keymap is
+     * valid until keymapLoaded is emitted again, use xkb_keymap_ref to keep it longer.
+     * @see setKeymapLoadingEnabled
+     * @since 6.7
+     **/
+    xkb_keymap *xkbKeymap() const;
+
     operator wl_keyboard *();
     operator wl_keyboard *() const;
 
@@ -140,6 +207,15 @@ Q_SIGNALS:
      * @param size The size of the keymap
      **/
     void keymapChanged(int fd, quint32 size);
+    /**
+     * Emitted when a keymap with different content than the current one got loaded.
+     * Only emitted if keymap loading is enabled, in that case keymapChanged is not emitted.
+     * @see setKeymapLoadingEnabled
+     * @see keymap
+     * @see xkbKeymap
+     * @since 6.7
+     **/
+    void keymapLoaded();
     /**
      * A key was pressed or released.
      * The time argument is a timestamp with millisecond granularity, with an undefined base.
@@ -6,6 +6,7 @@
 #include "output.h"
 #include "wayland_pointer_p.h"
 // Qt
+#include <QHash>
 #include <QList>
 #include <QPoint>
 #include <QRect>
@@ -25,7 +26,6 @@ class Q_DECL_HIDDEN Output::Private
 {
 public:
     Private(Output *q);
-    ~Private();
     void setup(wl_output *o);
 
     WaylandPointer<wl_output, wl_output_release> output;
@@ -43,6 +43,8 @@ public:
     QString description;
 
     static Output *get(wl_output *o);
+    // the Outputs by their wl_output for constant time lookups in get
+    static QHash<wl_output *, Output *> s_allOutputs;
 
 private:
     static void geometryCallback(void *data,
@@ -71,33 +73,21 @@ private:
 
     Output *q;
     static struct wl_output_listener s_outputListener;
-
-    static QList<Private *> s_allOutputs;
 };
 
-QList<Output::Private *> Output::Private::s_allOutputs;
+QHash<wl_output *, Output *> Output::Private::s_allOutputs;
 
 Output::Private::Private(Output *q)
     : q(q)
 {
-    s_allOutputs << this;
-}
-
-Output::Private::~Private()
-{
-    s_allOutputs.removeOne(this);
 }
 
 Output *Output::Private::get(wl_output *o)
 {
-    auto it = std::find_if(s_allOutputs.constBegin(), s_allOutputs.constEnd(), [o](Private *p) {
-        const wl_output *reference = p->output;
-        return reference == o;
-    });
-    if (it != s_allOutputs.constEnd()) {
-        return (*it)->q;
+    if (!o) {
+        return nullptr;
     }
-    return nullptr;
+    return s_allOutputs.value(o);
 }
 
 void Output::Private::setup(wl_output *o)
@@ -105,6 +95,7 @@ void Output::Private::setup(wl_output *o)
     Q_ASSERT(o);
     Q_ASSERT(!output);
     output.setup(o);
+    s_allOutputs.insert(o, q);
     wl_output_add_listener(output, &s_outputListener, this);
 }
 
@@ -121,6 +112,7 @@ Output::Output(QObject *parent)
 
 Output::~Output()
 {
+    Private::s_allOutputs.remove(d->output);
     d->output.release();
 }
 
@@ -418,6 +410,7 @@ Output *Output::get(wl_output *o)
 
 void Output::destroy()
 {
+    Private::s_allOutputs.remove(d->output);
     d->output.destroy();
 }
 
@@ -8,6 +8,8 @@
 #include "output.h"
 #include "surface.h"
 #include "wayland_pointer_p.h"
+// Qt
+#include <QHash>
 // Wayland
 #include <wayland-plasma-shell-client-protocol.h>
 
@@ -28,10 +30,13 @@ public:
     Private(PlasmaShellSurface *q);
     ~Private();
     void setup(org_kde_plasma_surface *surface);
+    void setParentSurface(Surface *surface);
 
     WaylandPointer<org_kde_plasma_surface, org_kde_plasma_surface_destroy> surface;
     QSize size;
     QPointer<Surface> parentSurface;
+    // the key of this PlasmaShellSurface in s_surfaces
+    Surface *registeredSurface = nullptr;
     PlasmaShellSurface::Role role;
 
     static PlasmaShellSurface *get(Surface *surface);
@@ -41,11 +46,12 @@ private:
     static void autoHidingPanelShownCallback(void *data, org_kde_plasma_surface *org_kde_plasma_surface);
 
     PlasmaShellSurface *q;
-    static QList<Private *> s_surfaces;
+    // the PlasmaShellSurfaces by their parent Surface for constant time lookups in get
+    static QHash<Surface *, Private *> s_surfaces;
     static const org_kde_plasma_surface_listener s_listener;
 };
 
-QList<PlasmaShellSurface::Private *> PlasmaShellSurface::Private::s_surfaces;
+QHash<Surface *, PlasmaShellSurface::Private *> PlasmaShellSurface::Private::s_surfaces;
 
 PlasmaShell::PlasmaShell(QObject *parent)
     : QObject(parent)
@@ -110,7 +116,7 @@ PlasmaShellSurface *PlasmaShell::createSurface(wl_surface *surface, QObject *par
         d->queue->addProxy(w);
     }
     s->setup(w);
-    s->d->parentSurface = QPointer<Surface>(kwS);
+    s->d->setParentSurface(kwS);
     return s;
 }
 
@@ -138,12 +144,23 @@ PlasmaShellSurface::Private::Private(PlasmaShellSurface *q)
     : role(PlasmaShellSurface::Role::Normal)
     , q(q)
 {
-    s_surfaces << this;
 }
 
 PlasmaShellSurface::Private::~Private()
 {
-    s_surfaces.removeAll(this);
+    auto it = s_surfaces.find(registeredSurface);
+    if (it != s_surfaces.end() && it.value() == this) {
+        s_surfaces.erase(it);
+    }
+}
+
+void PlasmaShellSurface::Private::setParentSurface(Surface *surface)
+{
+    parentSurface = QPointer<Surface>(surface);
+    if (surface) {
+        registeredSurface = surface;
+        s_surfaces.insert(surface, this);
+    }
 }
 
 PlasmaShellSurface *PlasmaShellSurface::Private::get(Surface *surface)
@@ -151,10 +168,10 @@ PlasmaShellSurface *PlasmaShellSurface::Private::get(Surface *surface)
     if (!surface) {
         return nullptr;
     }
-    for (auto it = s_surfaces.constBegin(); it != s_surfaces.constEnd(); ++it) {
-        if ((*it)->parentSurface == surface) {
-            return (*it)->q;
-        }
+    Private *p = s_surfaces.value(surface);
+    // the parent Surface might got deleted and another one allocated at the same address
+    if (p && p->parentSurface == surface) {
+        return p->q;
     }
     return nullptr;
 }
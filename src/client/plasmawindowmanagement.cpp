@@ -13,17 +13,101 @@
 // Wayland
 #include <wayland-plasma-window-management-client-protocol.h>
 
-#include <QFutureWatcher>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSocketNotifier>
 #include <QTimer>
-#include <QtConcurrentRun>
 #include <qplatformdefs.h>
 
 #include <cerrno>
+#include <fcntl.h>
+#include <memory>
 
 namespace KWayland
 {
 namespace Client
 {
+/**
+ * Process wide cache of the icons of all PlasmaWindows. Identical icons, e.g. of several
+ * windows of the same application, share one QIcon and a payload which is already known
+ * is not decoded again. The least recently used icons are evicted once the memory budget
+ * is exceeded.
+ **/
+class Q_DECL_HIDDEN IconCache
+{
+public:
+    IconCache();
+    QIcon themedIcon(const QString &name);
+    QIcon icon(const QByteArray &payload);
+    void setMaximumSize(qint64 bytes);
+    qint64 maximumSize();
+
+private:
+    // themed icons are loaded lazily by Qt, thus they only count with a small fixed cost
+    static constexpr qint64 s_themedIconCost = 1024;
+    QMutex mutex;
+    QCache<QByteArray, QIcon> cache;
+};
+
+Q_GLOBAL_STATIC(IconCache, s_iconCache)
+
+IconCache::IconCache()
+    : cache(16 * 1024 * 1024)
+{
+}
+
+QIcon IconCache::themedIcon(const QString &name)
+{
+    const QByteArray key = QByteArrayLiteral("theme:") + name.toUtf8();
+    QMutexLocker lock(&mutex);
+    if (QIcon *cached = cache.object(key)) {
+        return *cached;
+    }
+    const QIcon icon = QIcon::fromTheme(name);
+    cache.insert(key, new QIcon(icon), s_themedIconCost);
+    return icon;
+}
+
+QIcon IconCache::icon(const QByteArray &payload)
+{
+    const QByteArray key = QByteArrayLiteral("data:") + QCryptographicHash::hash(payload, QCryptographicHash::Sha1);
+    {
+        QMutexLocker lock(&mutex);
+        if (QIcon *cached = cache.object(key)) {
+            return *cached;
+        }
+    }
+    QDataStream ds(payload);
+    QIcon icon;
+    ds >> icon;
+    if (icon.isNull()) {
+        return icon;
+    }
+    qint64 cost = 0;
+    const auto sizes = icon.availableSizes();
+    for (const QSize &size : sizes) {
+        cost += qint64(size.width()) * size.height() * 4;
+    }
+    QMutexLocker lock(&mutex);
+    cache.insert(key, new QIcon(icon), qMax(cost, s_themedIconCost));
+    return icon;
+}
+
+void IconCache::setMaximumSize(qint64 bytes)
+{
+    QMutexLocker lock(&mutex);
+    cache.setMaxCost(qMax(qint64(0), bytes));
+}
+
+qint64 IconCache::maximumSize()
+{
+    QMutexLocker lock(&mutex);
+    return cache.maxCost();
+}
+
 class Q_DECL_HIDDEN PlasmaWindowManagement::Private : public QObject
 {
     Q_OBJECT
@@ -32,12 +116,37 @@ public:
     WaylandPointer<org_kde_plasma_window_management, org_kde_plasma_window_management_destroy> wm;
     EventQueue *queue = nullptr;
     bool showingDesktop = false;
+    // in creation order, removed windows are nullptr until compactWindows
     QList<PlasmaWindow *> windows;
+    struct WindowEntry {
+        // the position in windows
+        qsizetype position;
+        // empty if announced without uuid
+        QByteArray uuid;
+        org_kde_plasma_window *proxy;
+    };
+    // windows might be partially destroyed on removal, thus the keys are kept here
+    QHash<PlasmaWindow *, WindowEntry> windowEntries;
+    QHash<QByteArray, PlasmaWindow *> windowsByUuid;
+    QHash<org_kde_plasma_window *, PlasmaWindow *> windowsByProxy;
+    qsizetype removedWindows = 0;
     PlasmaWindow *activeWindow = nullptr;
     QList<quint32> stackingOrder;
     QList<QByteArray> stackingOrderUuids;
+    IconFetchPolicy iconFetchPolicy = IconFetchPolicy::Immediately;
+    int maximumIconFetches = 4;
+    int iconFetches = 0;
+    QList<QPointer<PlasmaWindow>> pendingIconFetches;
+    // windows which received their initial state since the last windowsCreated
+    QList<QPointer<PlasmaWindow>> createdWindows;
+    bool windowsCreatedScheduled = false;
 
     void setup(org_kde_plasma_window_management *wm);
+    void windowInitialized(PlasmaWindow *window);
+    void compactWindows();
+    void queueIconFetch(PlasmaWindow *window);
+    void iconFetchFinished();
+    void startIconFetches();
 
 private:
     static void showDesktopCallback(void *data, org_kde_plasma_window_management *org_kde_plasma_window_management, uint32_t state);
@@ -47,7 +156,11 @@ private:
     static void stackingOrderUuidsCallback(void *data, org_kde_plasma_window_management *org_kde_plasma_window_management, const char *uuids);
     static void stackingOrder2Callback(void *data, org_kde_plasma_window_management *interface);
     void setShowDesktop(bool set);
+    void scheduleWindowCreation(quint32 internalId, const QByteArray &uuid);
+    void createPendingWindows();
     void windowCreated(org_kde_plasma_window *id, quint32 internalId, const char *uuid);
+    void emitWindowsCreated();
+    void windowRemoved(PlasmaWindow *window);
     void setStackingOrder(const QList<quint32> &ids);
     void setStackingOrder(const QList<QByteArray> &uuids);
 
@@ -56,6 +169,14 @@ private:
 
     static struct org_kde_plasma_window_management_listener s_listener;
     static const org_kde_plasma_stacking_order_listener s_stackingOrderListener;
+
+    struct PendingWindow {
+        quint32 internalId;
+        // empty if announced without uuid
+        QByteArray uuid;
+    };
+    // windows announced in the current dispatch, created together by createPendingWindows
+    QList<PendingWindow> pendingWindows;
     PlasmaWindowManagement *q;
 };
 
@@ -69,25 +190,7 @@ public:
     QString title;
     QString appId;
     quint32 desktop = 0;
-    bool active = false;
-    bool minimized = false;
-    bool maximized = false;
-    bool fullscreen = false;
-    bool keepAbove = false;
-    bool keepBelow = false;
-    bool onAllDesktops = false;
-    bool demandsAttention = false;
-    bool closeable = false;
-    bool minimizeable = false;
-    bool maximizeable = false;
-    bool fullscreenable = false;
-    bool skipTaskbar = false;
-    bool skipSwitcher = false;
-    bool shadeable = false;
-    bool shaded = false;
-    bool movable = false;
-    bool resizable = false;
-    bool virtualDesktopChangeable = false;
+    States states;
     QIcon icon;
     PlasmaWindowManagement *wm = nullptr;
     bool unmapped = false;
@@ -101,6 +204,19 @@ public:
     QString applicationMenuServiceName;
     QString applicationMenuObjectPath;
     QRect clientGeometry;
+    QPointer<PlasmaWindowManagement::Private> wmPrivate;
+    // the server announced an icon which is not yet fetched
+    bool iconOutdated = false;
+    bool iconFetchQueued = false;
+    int iconFd = -1;
+    QByteArray iconData;
+    std::unique_ptr<QSocketNotifier> iconNotifier;
+    // gives up a fetch the compositor does not write to
+    QTimer *iconTimeout = nullptr;
+
+    ~Private();
+    void requestIcon();
+    bool startIconFetch();
 
 private:
     static void titleChangedCallback(void *data, org_kde_plasma_window *window, const char *title);
@@ -121,27 +237,11 @@ private:
     static void activityEnteredCallback(void *data, org_kde_plasma_window *org_kde_plasma_window, const char *id);
     static void activityLeftCallback(void *data, org_kde_plasma_window *org_kde_plasma_window, const char *id);
     static void clientGeometryCallback(void *data, org_kde_plasma_window *window, int32_t x, int32_t y, uint32_t width, uint32_t height);
-    void setActive(bool set);
-    void setMinimized(bool set);
-    void setMaximized(bool set);
-    void setFullscreen(bool set);
-    void setKeepAbove(bool set);
-    void setKeepBelow(bool set);
-    void setOnAllDesktops(bool set);
-    void setDemandsAttention(bool set);
-    void setCloseable(bool set);
-    void setMinimizeable(bool set);
-    void setMaximizeable(bool set);
-    void setFullscreenable(bool set);
-    void setSkipTaskbar(bool skip);
-    void setSkipSwitcher(bool skip);
-    void setShadeable(bool set);
-    void setShaded(bool set);
-    void setMovable(bool set);
-    void setResizable(bool set);
-    void setVirtualDesktopChangeable(bool set);
+    void setStates(States states);
     void setParentWindow(PlasmaWindow *parentWindow);
     void setPid(const quint32 pid);
+    void readIcon();
+    void finishIconFetch(bool success);
 
     static Private *cast(void *data)
     {
@@ -153,6 +253,8 @@ private:
     static struct org_kde_plasma_window_listener s_listener;
 };
 
+static const char s_unavailableUuid[] = "unavailable";
+
 struct StackingOrderData {
     QPointer<PlasmaWindowManagement::Private> wm;
     QList<QByteArray> list;
@@ -176,6 +278,8 @@ void PlasmaWindowManagement::Private::setup(org_kde_plasma_window_management *wi
 {
     Q_ASSERT(!wm);
     Q_ASSERT(windowManagement);
+    // windows announced by a previous interface
+    pendingWindows.clear();
     wm.setup(windowManagement);
     org_kde_plasma_window_management_add_listener(windowManagement, &s_listener, this);
 
@@ -220,39 +324,80 @@ void PlasmaWindowManagement::Private::windowCallback(void *data, org_kde_plasma_
 {
     auto wm = reinterpret_cast<PlasmaWindowManagement::Private *>(data);
     Q_ASSERT(wm->wm == interface);
-    QTimer *timer = new QTimer();
-    timer->setSingleShot(true);
-    timer->setInterval(0);
-    QObject::connect(
-        timer,
-        &QTimer::timeout,
-        wm->q,
-        [timer, wm, id] {
-            wm->windowCreated(org_kde_plasma_window_management_get_window(wm->wm, id), id, "unavailable");
-            timer->deleteLater();
-        },
-        Qt::QueuedConnection);
-    timer->start();
+    wm->scheduleWindowCreation(id, QByteArray());
 }
 
 void PlasmaWindowManagement::Private::windowWithUuidCallback(void *data, org_kde_plasma_window_management *interface, uint32_t id, const char *_uuid)
 {
-    QByteArray uuid(_uuid);
     auto wm = reinterpret_cast<PlasmaWindowManagement::Private *>(data);
     Q_ASSERT(wm->wm == interface);
-    QTimer *timer = new QTimer();
-    timer->setSingleShot(true);
-    timer->setInterval(0);
-    QObject::connect(
-        timer,
-        &QTimer::timeout,
-        wm->q,
-        [timer, wm, id, uuid] {
-            wm->windowCreated(org_kde_plasma_window_management_get_window_by_uuid(wm->wm, uuid), id, uuid);
-            timer->deleteLater();
+    wm->scheduleWindowCreation(id, QByteArray(_uuid));
+}
+
+void PlasmaWindowManagement::Private::scheduleWindowCreation(quint32 internalId, const QByteArray &uuid)
+{
+    // the windows are created deferred, all windows announced until then at once
+    const bool scheduled = !pendingWindows.isEmpty();
+    pendingWindows.append(PendingWindow{internalId, uuid});
+    if (scheduled) {
+        return;
+    }
+    QMetaObject::invokeMethod(
+        q,
+        [this] {
+            createPendingWindows();
         },
         Qt::QueuedConnection);
-    timer->start();
+}
+
+void PlasmaWindowManagement::Private::createPendingWindows()
+{
+    const QList<PendingWindow> pending = std::exchange(pendingWindows, {});
+    if (pending.isEmpty() || !wm.isValid()) {
+        return;
+    }
+    windows.reserve(windows.count() + pending.count());
+    windowEntries.reserve(windowEntries.count() + pending.count());
+    for (const PendingWindow &window : pending) {
+        if (window.uuid.isEmpty()) {
+            windowCreated(org_kde_plasma_window_management_get_window(wm, window.internalId), window.internalId, s_unavailableUuid);
+        } else {
+            windowCreated(org_kde_plasma_window_management_get_window_by_uuid(wm, window.uuid.constData()), window.internalId, window.uuid.constData());
+        }
+    }
+    wl_display_flush(wl_proxy_get_display(wm));
+}
+
+void PlasmaWindowManagement::Private::windowInitialized(PlasmaWindow *window)
+{
+    Q_EMIT q->windowCreated(window);
+    createdWindows << window;
+    if (windowsCreatedScheduled) {
+        return;
+    }
+    windowsCreatedScheduled = true;
+    QMetaObject::invokeMethod(
+        q,
+        [this] {
+            windowsCreatedScheduled = false;
+            emitWindowsCreated();
+        },
+        Qt::QueuedConnection);
+}
+
+void PlasmaWindowManagement::Private::emitWindowsCreated()
+{
+    const QList<QPointer<PlasmaWindow>> created = std::exchange(createdWindows, {});
+    QList<PlasmaWindow *> announced;
+    announced.reserve(created.count());
+    for (const QPointer<PlasmaWindow> &window : created) {
+        if (window && !window->d->unmapped) {
+            announced << window;
+        }
+    }
+    if (!announced.isEmpty()) {
+        Q_EMIT q->windowsCreated(announced);
+    }
 }
 
 void PlasmaWindowManagement::Private::windowCreated(org_kde_plasma_window *id, quint32 internalId, const char *uuid)
@@ -262,14 +407,19 @@ void PlasmaWindowManagement::Private::windowCreated(org_kde_plasma_window *id, q
     }
     PlasmaWindow *window = new PlasmaWindow(q, id, internalId, uuid);
     window->d->wm = q;
+    window->d->wmPrivate = this;
+    WindowEntry entry{windows.count(), QByteArray(), id};
+    // windows announced without uuid all share the same placeholder
+    if (qstrcmp(uuid, s_unavailableUuid) != 0) {
+        entry.uuid = window->d->uuid;
+        windowsByUuid.insert(entry.uuid, window);
+    }
+    windowEntries.insert(window, entry);
     windows << window;
+    windowsByProxy.insert(id, window);
 
     const auto windowRemoved = [this, window] {
-        windows.removeAll(window);
-        if (activeWindow == window) {
-            activeWindow = nullptr;
-            Q_EMIT q->activeWindowChanged();
-        }
+        this->windowRemoved(window);
     };
 
     QObject::connect(window, &QObject::destroyed, q, windowRemoved);
@@ -295,6 +445,42 @@ void PlasmaWindowManagement::Private::windowCreated(org_kde_plasma_window *id, q
     });
 }
 
+void PlasmaWindowManagement::Private::windowRemoved(PlasmaWindow *window)
+{
+    const auto it = windowEntries.constFind(window);
+    if (it == windowEntries.constEnd()) {
+        return;
+    }
+    windows[it->position] = nullptr;
+    ++removedWindows;
+    if (!it->uuid.isEmpty() && windowsByUuid.value(it->uuid) == window) {
+        windowsByUuid.remove(it->uuid);
+    }
+    if (windowsByProxy.value(it->proxy) == window) {
+        windowsByProxy.remove(it->proxy);
+    }
+    windowEntries.erase(it);
+    if (removedWindows > windows.count() / 2) {
+        compactWindows();
+    }
+    if (activeWindow == window) {
+        activeWindow = nullptr;
+        Q_EMIT q->activeWindowChanged();
+    }
+}
+
+void PlasmaWindowManagement::Private::compactWindows()
+{
+    if (removedWindows == 0) {
+        return;
+    }
+    windows.removeAll(nullptr);
+    removedWindows = 0;
+    for (qsizetype i = 0; i < windows.count(); ++i) {
+        windowEntries[windows.at(i)].position = i;
+    }
+}
+
 void PlasmaWindowManagement::Private::stackingOrderCallback(void *data, org_kde_plasma_window_management *interface, wl_array *ids)
 {
     // This is no-op since setStackingOrder(const QList<quint32> &ids) is deprecated since 5.73,
@@ -353,6 +539,28 @@ void PlasmaWindowManagement::Private::setStackingOrder(const QList<QByteArray> &
     Q_EMIT q->stackingOrderUuidsChanged();
 }
 
+void PlasmaWindowManagement::Private::queueIconFetch(PlasmaWindow *window)
+{
+    pendingIconFetches << window;
+    startIconFetches();
+}
+
+void PlasmaWindowManagement::Private::iconFetchFinished()
+{
+    --iconFetches;
+    startIconFetches();
+}
+
+void PlasmaWindowManagement::Private::startIconFetches()
+{
+    while (iconFetches < maximumIconFetches && !pendingIconFetches.isEmpty()) {
+        PlasmaWindow *window = pendingIconFetches.takeFirst();
+        if (window && window->d->startIconFetch()) {
+            ++iconFetches;
+        }
+    }
+}
+
 PlasmaWindowManagement::PlasmaWindowManagement(QObject *parent)
     : QObject(parent)
     , d(new Private(this))
@@ -436,9 +644,27 @@ bool PlasmaWindowManagement::isShowingDesktop() const
 
 QList<PlasmaWindow *> PlasmaWindowManagement::windows() const
 {
+    d->compactWindows();
     return d->windows;
 }
 
+PlasmaWindow *PlasmaWindowManagement::windowForUuid(const QByteArray &uuid) const
+{
+    return d->windowsByUuid.value(uuid);
+}
+
+QList<PlasmaWindow *> PlasmaWindowManagement::stackingOrderWindows() const
+{
+    QList<PlasmaWindow *> stackingOrder;
+    stackingOrder.reserve(d->stackingOrderUuids.count());
+    for (const QByteArray &uuid : std::as_const(d->stackingOrderUuids)) {
+        if (PlasmaWindow *window = d->windowsByUuid.value(uuid)) {
+            stackingOrder << window;
+        }
+    }
+    return stackingOrder;
+}
+
 PlasmaWindow *PlasmaWindowManagement::activeWindow() const
 {
     return d->activeWindow;
@@ -454,6 +680,46 @@ QList<QByteArray> PlasmaWindowManagement::stackingOrderUuids() const
     return d->stackingOrderUuids;
 }
 
+void PlasmaWindowManagement::setIconFetchPolicy(IconFetchPolicy policy)
+{
+    if (d->iconFetchPolicy == policy) {
+        return;
+    }
+    d->iconFetchPolicy = policy;
+    if (policy == IconFetchPolicy::Immediately) {
+        d->compactWindows();
+        for (PlasmaWindow *window : std::as_const(d->windows)) {
+            window->d->requestIcon();
+        }
+    }
+}
+
+PlasmaWindowManagement::IconFetchPolicy PlasmaWindowManagement::iconFetchPolicy() const
+{
+    return d->iconFetchPolicy;
+}
+
+void PlasmaWindowManagement::setMaximumIconFetches(int maximum)
+{
+    d->maximumIconFetches = qMax(1, maximum);
+    d->startIconFetches();
+}
+
+int PlasmaWindowManagement::maximumIconFetches() const
+{
+    return d->maximumIconFetches;
+}
+
+void PlasmaWindowManagement::setIconCacheSize(qint64 bytes)
+{
+    s_iconCache->setMaximumSize(bytes);
+}
+
+qint64 PlasmaWindowManagement::iconCacheSize()
+{
+    return s_iconCache->maximumSize();
+}
+
 org_kde_plasma_window_listener PlasmaWindow::Private::s_listener = {
     titleChangedCallback,
     appIdChangedCallback,
@@ -491,11 +757,7 @@ void PlasmaWindow::Private::parentWindowCallback(void *data, org_kde_plasma_wind
 {
     Q_UNUSED(window)
     Private *p = cast(data);
-    const auto windows = p->wm->windows();
-    auto it = std::find_if(windows.constBegin(), windows.constEnd(), [parent](const PlasmaWindow *w) {
-        return *w == parent;
-    });
-    p->setParentWindow(it != windows.constEnd() ? *it : nullptr);
+    p->setParentWindow(p->wmPrivate && parent ? p->wmPrivate->windowsByProxy.value(parent) : nullptr);
 }
 
 void PlasmaWindow::Private::windowGeometryCallback(void *data, org_kde_plasma_window *window, int32_t x, int32_t y, uint32_t width, uint32_t height)
@@ -532,7 +794,12 @@ void PlasmaWindow::Private::initialStateCallback(void *data, org_kde_plasma_wind
 {
     Q_UNUSED(window)
     Private *p = cast(data);
-    if (!p->unmapped) {
+    if (p->unmapped) {
+        return;
+    }
+    if (p->wmPrivate) {
+        p->wmPrivate->windowInitialized(p->q);
+    } else {
         Q_EMIT p->wm->windowCreated(p->q);
     }
 }
@@ -645,25 +912,35 @@ void PlasmaWindow::Private::stateChangedCallback(void *data, org_kde_plasma_wind
 {
     auto p = cast(data);
     Q_UNUSED(window);
-    p->setActive(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ACTIVE);
-    p->setMinimized(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED);
-    p->setMaximized(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZED);
-    p->setFullscreen(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREEN);
-    p->setKeepAbove(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_ABOVE);
-    p->setKeepBelow(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_BELOW);
-    p->setOnAllDesktops(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ON_ALL_DESKTOPS);
-    p->setDemandsAttention(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_DEMANDS_ATTENTION);
-    p->setCloseable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_CLOSEABLE);
-    p->setFullscreenable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREENABLE);
-    p->setMaximizeable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZABLE);
-    p->setMinimizeable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZABLE);
-    p->setSkipTaskbar(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SKIPTASKBAR);
-    p->setSkipSwitcher(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SKIPSWITCHER);
-    p->setShadeable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SHADEABLE);
-    p->setShaded(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SHADED);
-    p->setMovable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MOVABLE);
-    p->setResizable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_RESIZABLE);
-    p->setVirtualDesktopChangeable(state & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_VIRTUAL_DESKTOP_CHANGEABLE);
+    static const struct {
+        uint32_t protocolState;
+        State state;
+    } s_states[] = {
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ACTIVE, State::Active},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED, State::Minimized},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZED, State::Maximized},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREEN, State::Fullscreen},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_ABOVE, State::KeepAbove},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_BELOW, State::KeepBelow},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ON_ALL_DESKTOPS, State::OnAllDesktops},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_DEMANDS_ATTENTION, State::DemandsAttention},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_CLOSEABLE, State::Closeable},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZABLE, State::Minimizeable},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZABLE, State::Maximizeable},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREENABLE, State::Fullscreenable},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SKIPTASKBAR, State::SkipTaskbar},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SKIPSWITCHER, State::SkipSwitcher},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SHADEABLE, State::Shadeable},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SHADED, State::Shaded},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MOVABLE, State::Movable},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_RESIZABLE, State::Resizable},
+        {ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_VIRTUAL_DESKTOP_CHANGEABLE, State::VirtualDesktopChangeable},
+    };
+    States states;
+    for (const auto &s : s_states) {
+        states.setFlag(s.state, state & s.protocolState);
+    }
+    p->setStates(states);
 }
 
 void PlasmaWindow::Private::themedIconNameChangedCallback(void *data, org_kde_plasma_window *window, const char *name)
@@ -672,239 +949,161 @@ void PlasmaWindow::Private::themedIconNameChangedCallback(void *data, org_kde_pl
     Q_UNUSED(window);
     const QString themedName = QString::fromUtf8(name);
     if (!themedName.isEmpty()) {
-        QIcon icon = QIcon::fromTheme(themedName);
-        p->icon = icon;
+        p->icon = s_iconCache->themedIcon(themedName);
     } else {
         p->icon = QIcon();
     }
     Q_EMIT p->q->iconChanged();
 }
 
-static int readData(int fd, QByteArray &data)
-{
-    // implementation based on QtWayland file qwaylanddataoffer.cpp
-    char buf[4096];
-    int retryCount = 0;
-    int n;
-    while (true) {
-        n = QT_READ(fd, buf, sizeof buf);
-        if (n > 0) {
-            data.append(buf, n);
-        } else if (n == -1 && (errno == EAGAIN) && ++retryCount < 1000) {
-            usleep(1000);
-        } else {
-            break;
-        }
-    }
-    return n;
-}
-
 void PlasmaWindow::Private::iconChangedCallback(void *data, org_kde_plasma_window *window)
 {
     auto p = cast(data);
     Q_UNUSED(window);
-    int pipeFds[2];
-    if (pipe2(pipeFds, O_CLOEXEC | O_NONBLOCK) != 0) {
-        return;
-    }
-    org_kde_plasma_window_get_icon(p->window, pipeFds[1]);
-    close(pipeFds[1]);
-    const int pipeFd = pipeFds[0];
-    auto readIcon = [pipeFd]() -> QIcon {
-        QByteArray content;
-        if (readData(pipeFd, content) != 0) {
-            close(pipeFd);
-            return QIcon();
-        }
-        close(pipeFd);
-        QDataStream ds(content);
-        QIcon icon;
-        ds >> icon;
-        return icon;
-    };
-    QFutureWatcher<QIcon> *watcher = new QFutureWatcher<QIcon>(p->q);
-    QObject::connect(watcher, &QFutureWatcher<QIcon>::finished, p->q, [p, watcher] {
-        watcher->deleteLater();
-        QIcon icon = watcher->result();
-        if (!icon.isNull()) {
-            p->icon = icon;
-        } else {
-            p->icon = QIcon::fromTheme(QStringLiteral("wayland"));
-        }
+    p->iconOutdated = true;
+    if (p->wmPrivate && p->wmPrivate->iconFetchPolicy == PlasmaWindowManagement::IconFetchPolicy::OnDemand) {
+        // users of the icon query it again, which starts the fetch
         Q_EMIT p->q->iconChanged();
-    });
-    watcher->setFuture(QtConcurrent::run(readIcon));
-}
-
-void PlasmaWindow::Private::setActive(bool set)
-{
-    if (active == set) {
         return;
     }
-    active = set;
-    Q_EMIT q->activeChanged();
+    p->requestIcon();
 }
 
-void PlasmaWindow::Private::setFullscreen(bool set)
+void PlasmaWindow::Private::requestIcon()
 {
-    if (fullscreen == set) {
+    // a running fetch gets repeated once it finished
+    if (!iconOutdated || iconFetchQueued || iconNotifier) {
         return;
     }
-    fullscreen = set;
-    Q_EMIT q->fullscreenChanged();
-}
-
-void PlasmaWindow::Private::setKeepAbove(bool set)
-{
-    if (keepAbove == set) {
+    if (!wmPrivate) {
+        startIconFetch();
         return;
     }
-    keepAbove = set;
-    Q_EMIT q->keepAboveChanged();
+    iconFetchQueued = true;
+    wmPrivate->queueIconFetch(q);
 }
 
-void PlasmaWindow::Private::setKeepBelow(bool set)
-{
-    if (keepBelow == set) {
-        return;
-    }
-    keepBelow = set;
-    Q_EMIT q->keepBelowChanged();
-}
-
-void PlasmaWindow::Private::setMaximized(bool set)
-{
-    if (maximized == set) {
-        return;
-    }
-    maximized = set;
-    Q_EMIT q->maximizedChanged();
-}
+// like the former blocking read, give up once the compositor did not write for a second
+static const int s_iconFetchTimeout = 1000;
 
-void PlasmaWindow::Private::setMinimized(bool set)
+bool PlasmaWindow::Private::startIconFetch()
 {
-    if (minimized == set) {
-        return;
-    }
-    minimized = set;
-    Q_EMIT q->minimizedChanged();
-}
-
-void PlasmaWindow::Private::setOnAllDesktops(bool set)
-{
-    if (onAllDesktops == set) {
-        return;
-    }
-    onAllDesktops = set;
-    Q_EMIT q->onAllDesktopsChanged();
-}
-
-void PlasmaWindow::Private::setDemandsAttention(bool set)
-{
-    if (demandsAttention == set) {
-        return;
-    }
-    demandsAttention = set;
-    Q_EMIT q->demandsAttentionChanged();
-}
-
-void PlasmaWindow::Private::setCloseable(bool set)
-{
-    if (closeable == set) {
-        return;
-    }
-    closeable = set;
-    Q_EMIT q->closeableChanged();
-}
-
-void PlasmaWindow::Private::setFullscreenable(bool set)
-{
-    if (fullscreenable == set) {
-        return;
-    }
-    fullscreenable = set;
-    Q_EMIT q->fullscreenableChanged();
-}
-
-void PlasmaWindow::Private::setMaximizeable(bool set)
-{
-    if (maximizeable == set) {
-        return;
+    iconFetchQueued = false;
+    int pipeFds[2];
+    // the compositor might write with a blocking write, only the read end is non-blocking
+    if (!window.isValid() || pipe2(pipeFds, O_CLOEXEC) != 0) {
+        return false;
     }
-    maximizeable = set;
-    Q_EMIT q->maximizeableChanged();
-}
-
-void PlasmaWindow::Private::setMinimizeable(bool set)
-{
-    if (minimizeable == set) {
-        return;
+    iconOutdated = false;
+    org_kde_plasma_window_get_icon(window, pipeFds[1]);
+    close(pipeFds[1]);
+    iconFd = pipeFds[0];
+    fcntl(iconFd, F_SETFL, fcntl(iconFd, F_GETFL) | O_NONBLOCK);
+    iconNotifier.reset(new QSocketNotifier(iconFd, QSocketNotifier::Read));
+    QObject::connect(iconNotifier.get(), &QSocketNotifier::activated, q, [this] {
+        readIcon();
+    });
+    if (!iconTimeout) {
+        iconTimeout = new QTimer(q);
+        iconTimeout->setSingleShot(true);
+        iconTimeout->setInterval(s_iconFetchTimeout);
+        QObject::connect(iconTimeout, &QTimer::timeout, q, [this] {
+            finishIconFetch(false);
+        });
     }
-    minimizeable = set;
-    Q_EMIT q->minimizeableChanged();
+    iconTimeout->start();
+    return true;
 }
 
-void PlasmaWindow::Private::setSkipTaskbar(bool skip)
+void PlasmaWindow::Private::readIcon()
 {
-    if (skipTaskbar == skip) {
-        return;
+    // implementation based on QtWayland file qwaylanddataoffer.cpp
+    char buf[4096];
+    while (true) {
+        const int n = QT_READ(iconFd, buf, sizeof buf);
+        if (n > 0) {
+            iconData.append(buf, n);
+            iconTimeout->start();
+        } else if (n == -1 && errno == EINTR) {
+            continue;
+        } else if (n == -1 && errno == EAGAIN) {
+            // the server did not write everything yet, wait for the next activation
+            return;
+        } else {
+            finishIconFetch(n == 0);
+            return;
+        }
     }
-    skipTaskbar = skip;
-    Q_EMIT q->skipTaskbarChanged();
 }
 
-void PlasmaWindow::Private::setSkipSwitcher(bool skip)
+void PlasmaWindow::Private::finishIconFetch(bool success)
 {
-    if (skipSwitcher == skip) {
-        return;
-    }
-    skipSwitcher = skip;
-    Q_EMIT q->skipSwitcherChanged();
-}
+    // called from the activated signal of the notifier or the timeout
+    iconTimeout->stop();
+    iconNotifier->setEnabled(false);
+    iconNotifier.release()->deleteLater();
+    close(iconFd);
+    iconFd = -1;
+    const QByteArray content = std::exchange(iconData, QByteArray());
 
-void PlasmaWindow::Private::setShadeable(bool set)
-{
-    if (shadeable == set) {
-        return;
+    QIcon fetchedIcon;
+    if (success && !content.isEmpty()) {
+        fetchedIcon = s_iconCache->icon(content);
     }
-    shadeable = set;
-    Q_EMIT q->shadeableChanged();
-}
-
-void PlasmaWindow::Private::setShaded(bool set)
-{
-    if (shaded == set) {
-        return;
+    if (!fetchedIcon.isNull()) {
+        icon = fetchedIcon;
+    } else {
+        icon = s_iconCache->themedIcon(QStringLiteral("wayland"));
     }
-    shaded = set;
-    Q_EMIT q->shadedChanged();
-}
 
-void PlasmaWindow::Private::setMovable(bool set)
-{
-    if (movable == set) {
-        return;
+    if (wmPrivate) {
+        wmPrivate->iconFetchFinished();
+        if (wmPrivate->iconFetchPolicy == PlasmaWindowManagement::IconFetchPolicy::Immediately) {
+            requestIcon();
+        }
     }
-    movable = set;
-    Q_EMIT q->movableChanged();
+    Q_EMIT q->iconChanged();
 }
 
-void PlasmaWindow::Private::setResizable(bool set)
+void PlasmaWindow::Private::setStates(States newStates)
 {
-    if (resizable == set) {
+    const States oldStates = states;
+    const States changed = oldStates ^ newStates;
+    if (!changed) {
         return;
     }
-    resizable = set;
-    Q_EMIT q->resizableChanged();
-}
-
-void PlasmaWindow::Private::setVirtualDesktopChangeable(bool set)
-{
-    if (virtualDesktopChangeable == set) {
-        return;
+    states = newStates;
+
+    static const struct {
+        State state;
+        void (PlasmaWindow::*signal)();
+    } s_signals[] = {
+        {State::Active, &PlasmaWindow::activeChanged},
+        {State::Minimized, &PlasmaWindow::minimizedChanged},
+        {State::Maximized, &PlasmaWindow::maximizedChanged},
+        {State::Fullscreen, &PlasmaWindow::fullscreenChanged},
+        {State::KeepAbove, &PlasmaWindow::keepAboveChanged},
+        {State::KeepBelow, &PlasmaWindow::keepBelowChanged},
+        {State::OnAllDesktops, &PlasmaWindow::onAllDesktopsChanged},
+        {State::DemandsAttention, &PlasmaWindow::demandsAttentionChanged},
+        {State::Closeable, &PlasmaWindow::closeableChanged},
+        {State::Minimizeable, &PlasmaWindow::minimizeableChanged},
+        {State::Maximizeable, &PlasmaWindow::maximizeableChanged},
+        {State::Fullscreenable, &PlasmaWindow::fullscreenableChanged},
+        {State::SkipTaskbar, &PlasmaWindow::skipTaskbarChanged},
+        {State::SkipSwitcher, &PlasmaWindow::skipSwitcherChanged},
+        {State::Shadeable, &PlasmaWindow::shadeableChanged},
+        {State::Shaded, &PlasmaWindow::shadedChanged},
+        {State::Movable, &PlasmaWindow::movableChanged},
+        {State::Resizable, &PlasmaWindow::resizableChanged},
+        {State::VirtualDesktopChangeable, &PlasmaWindow::virtualDesktopChangeableChanged},
+    };
+    for (const auto &s : s_signals) {
+        if (changed.testFlag(s.state)) {
+            Q_EMIT(q->*s.signal)();
+        }
     }
-    virtualDesktopChangeable = set;
-    Q_EMIT q->virtualDesktopChangeableChanged();
+    Q_EMIT q->statesChanged(oldStates, newStates);
 }
 
 PlasmaWindow::Private::Private(org_kde_plasma_window *w, quint32 internalId, const char *uuid, PlasmaWindow *q)
@@ -917,6 +1116,19 @@ PlasmaWindow::Private::Private(org_kde_plasma_window *w, quint32 internalId, con
     org_kde_plasma_window_add_listener(w, &s_listener, this);
 }
 
+PlasmaWindow::Private::~Private()
+{
+    if (iconNotifier) {
+        iconNotifier.reset();
+        close(iconFd);
+        if (wmPrivate) {
+            wmPrivate->iconFetchFinished();
+        }
+    } else if (iconFetchQueued && wmPrivate) {
+        wmPrivate->pendingIconFetches.removeOne(q);
+    }
+}
+
 PlasmaWindow::PlasmaWindow(PlasmaWindowManagement *parent, org_kde_plasma_window *window, quint32 internalId, const char *uuid)
     : QObject(parent)
     , d(new Private(window, internalId, uuid, this))
@@ -975,39 +1187,39 @@ QString PlasmaWindow::title() const
 
 bool PlasmaWindow::isActive() const
 {
-    return d->active;
+    return d->states.testFlag(State::Active);
 }
 
 bool PlasmaWindow::isFullscreen() const
 {
-    return d->fullscreen;
+    return d->states.testFlag(State::Fullscreen);
 }
 
 bool PlasmaWindow::isKeepAbove() const
 {
-    return d->keepAbove;
+    return d->states.testFlag(State::KeepAbove);
 }
 
 bool PlasmaWindow::isKeepBelow() const
 {
-    return d->keepBelow;
+    return d->states.testFlag(State::KeepBelow);
 }
 
 bool PlasmaWindow::isMaximized() const
 {
-    return d->maximized;
+    return d->states.testFlag(State::Maximized);
 }
 
 bool PlasmaWindow::isMinimized() const
 {
-    return d->minimized;
+    return d->states.testFlag(State::Minimized);
 }
 
 bool PlasmaWindow::isOnAllDesktops() const
 {
     // from protocol version 8 virtual desktops are managed by plasmaVirtualDesktops
     if (org_kde_plasma_window_get_version(d->window) < 8) {
-        return d->onAllDesktops;
+        return d->states.testFlag(State::OnAllDesktops);
     } else {
         return d->plasmaVirtualDesktops.isEmpty();
     }
@@ -1015,67 +1227,75 @@ bool PlasmaWindow::isOnAllDesktops() const
 
 bool PlasmaWindow::isDemandingAttention() const
 {
-    return d->demandsAttention;
+    return d->states.testFlag(State::DemandsAttention);
 }
 
 bool PlasmaWindow::isCloseable() const
 {
-    return d->closeable;
+    return d->states.testFlag(State::Closeable);
 }
 
 bool PlasmaWindow::isFullscreenable() const
 {
-    return d->fullscreenable;
+    return d->states.testFlag(State::Fullscreenable);
 }
 
 bool PlasmaWindow::isMaximizeable() const
 {
-    return d->maximizeable;
+    return d->states.testFlag(State::Maximizeable);
 }
 
 bool PlasmaWindow::isMinimizeable() const
 {
-    return d->minimizeable;
+    return d->states.testFlag(State::Minimizeable);
 }
 
 bool PlasmaWindow::skipTaskbar() const
 {
-    return d->skipTaskbar;
+    return d->states.testFlag(State::SkipTaskbar);
 }
 
 bool PlasmaWindow::skipSwitcher() const
 {
-    return d->skipSwitcher;
+    return d->states.testFlag(State::SkipSwitcher);
 }
 
 QIcon PlasmaWindow::icon() const
 {
+    if (d->iconOutdated) {
+        d->requestIcon();
+    }
     return d->icon;
 }
 
 bool PlasmaWindow::isShadeable() const
 {
-    return d->shadeable;
+    return d->states.testFlag(State::Shadeable);
 }
 
 bool PlasmaWindow::isShaded() const
 {
-    return d->shaded;
+    return d->states.testFlag(State::Shaded);
 }
 
 bool PlasmaWindow::isResizable() const
 {
-    return d->resizable;
+    return d->states.testFlag(State::Resizable);
 }
 
 bool PlasmaWindow::isMovable() const
 {
-    return d->movable;
+    return d->states.testFlag(State::Movable);
 }
 
 bool PlasmaWindow::isVirtualDesktopChangeable() const
 {
-    return d->virtualDesktopChangeable;
+    return d->states.testFlag(State::VirtualDesktopChangeable);
+}
+
+PlasmaWindow::States PlasmaWindow::states() const
+{
+    return d->states;
 }
 
 QString PlasmaWindow::applicationMenuObjectPath() const
@@ -1110,7 +1330,7 @@ void PlasmaWindow::requestResize()
 
 void PlasmaWindow::requestToggleKeepAbove()
 {
-    if (d->keepAbove) {
+    if (d->states.testFlag(State::KeepAbove)) {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_ABOVE, 0);
     } else {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_ABOVE, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_ABOVE);
@@ -1119,7 +1339,7 @@ void PlasmaWindow::requestToggleKeepAbove()
 
 void PlasmaWindow::requestToggleKeepBelow()
 {
-    if (d->keepBelow) {
+    if (d->states.testFlag(State::KeepBelow)) {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_BELOW, 0);
     } else {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_BELOW, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_KEEP_BELOW);
@@ -1128,7 +1348,7 @@ void PlasmaWindow::requestToggleKeepBelow()
 
 void PlasmaWindow::requestToggleMinimized()
 {
-    if (d->minimized) {
+    if (d->states.testFlag(State::Minimized)) {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED, 0);
     } else {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED);
@@ -1137,7 +1357,7 @@ void PlasmaWindow::requestToggleMinimized()
 
 void PlasmaWindow::requestToggleMaximized()
 {
-    if (d->maximized) {
+    if (d->states.testFlag(State::Maximized)) {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZED, 0);
     } else {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZED, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZED);
@@ -1146,7 +1366,7 @@ void PlasmaWindow::requestToggleMaximized()
 
 void PlasmaWindow::requestToggleFullscreen()
 {
-    if (d->fullscreen) {
+    if (d->states.testFlag(State::Fullscreen)) {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREEN, 0);
     } else {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREEN, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREEN);
@@ -1165,7 +1385,7 @@ void PlasmaWindow::unsetMinimizedGeometry(Surface *panel)
 
 void PlasmaWindow::requestToggleShaded()
 {
-    if (d->shaded) {
+    if (d->states.testFlag(State::Shaded)) {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SHADED, 0);
     } else {
         org_kde_plasma_window_set_state(d->window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SHADED, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SHADED);
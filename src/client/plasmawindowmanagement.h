@@ -62,6 +62,25 @@ class KWAYLANDCLIENT_EXPORT PlasmaWindowManagement : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * Describes when the icon of a PlasmaWindow gets fetched from the server.
+     * @see setIconFetchPolicy
+     * @since 6.7
+     **/
+    enum class IconFetchPolicy {
+        /**
+         * The icon is fetched as soon as the server announces a new icon.
+         **/
+        Immediately,
+        /**
+         * The icon is only fetched once {@link PlasmaWindow::icon} gets called after
+         * the server announced a new icon. Until the icon is fetched {@link PlasmaWindow::icon}
+         * returns the previous icon.
+         **/
+        OnDemand,
+    };
+    Q_ENUM(IconFetchPolicy)
+
     explicit PlasmaWindowManagement(QObject *parent = nullptr);
     ~PlasmaWindowManagement() override;
 
@@ -166,6 +185,66 @@ public:
      */
     QList<QByteArray> stackingOrderUuids() const;
 
+    /**
+     * @returns The PlasmaWindow with the given @p uuid or @c nullptr if there is none
+     * @see PlasmaWindow::uuid
+     * @since 6.7
+     **/
+    PlasmaWindow *windowForUuid(const QByteArray &uuid) const;
+    /**
+     * @returns The known windows in stacking order, resolved from stackingOrderUuids
+     * @see stackingOrderUuids
+     * @see stackingOrderUuidsChanged
+     * @since 6.7
+     **/
+    QList<PlasmaWindow *> stackingOrderWindows() const;
+
+    /**
+     * Sets when the icons of the PlasmaWindows get fetched. The default is
+     * IconFetchPolicy::Immediately.
+     *
+     * With IconFetchPolicy::OnDemand only icons of windows which are actually shown get
+     * fetched, e.g. the icons for the visible rows of a PlasmaWindowModel.
+     * @see iconFetchPolicy
+     * @since 6.7
+     **/
+    void setIconFetchPolicy(IconFetchPolicy policy);
+    /**
+     * @returns when the icons of the PlasmaWindows get fetched
+     * @see setIconFetchPolicy
+     * @since 6.7
+     **/
+    IconFetchPolicy iconFetchPolicy() const;
+    /**
+     * Sets the @p maximum number of icons which are fetched at the same time. Further
+     * icon fetches are queued until a running fetch finishes. The default is @c 4.
+     * @see maximumIconFetches
+     * @since 6.7
+     **/
+    void setMaximumIconFetches(int maximum);
+    /**
+     * @returns the maximum number of icons fetched at the same time
+     * @see setMaximumIconFetches
+     * @since 6.7
+     **/
+    int maximumIconFetches() const;
+
+    /**
+     * Sets the memory budget in @p bytes of the icon cache. The cache is shared by all
+     * PlasmaWindows of the process, windows with identical icons share one QIcon. Once the
+     * budget is exceeded the least recently used icons are evicted. A budget of @c 0
+     * disables the cache. The default is 16 MiB.
+     * @see iconCacheSize
+     * @since 6.7
+     **/
+    static void setIconCacheSize(qint64 bytes);
+    /**
+     * @returns the memory budget in bytes of the icon cache shared by all PlasmaWindows
+     * @see setIconCacheSize
+     * @since 6.7
+     **/
+    static qint64 iconCacheSize();
+
 Q_SIGNALS:
     /**
      * This signal is emitted right before the interface is released.
@@ -186,6 +265,15 @@ Q_SIGNALS:
      * @see windows
      **/
     void windowCreated(KWayland::Client::PlasmaWindow *window);
+    /**
+     * Emitted once for all @p windows which got created together, e.g. the windows already
+     * existing when binding the interface. The signal is emitted after windowCreated got
+     * emitted for each of the @p windows. Windows which got unmapped in the meantime are
+     * not included.
+     * @see windowCreated
+     * @since 6.7
+     **/
+    void windowsCreated(const QList<KWayland::Client::PlasmaWindow *> &windows);
     /**
      * The active window changed.
      * @see activeWindow
@@ -233,6 +321,36 @@ class KWAYLANDCLIENT_EXPORT PlasmaWindow : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * The states of a PlasmaWindow as reported together by the server.
+     * @see states
+     * @see statesChanged
+     * @since 6.7
+     **/
+    enum class State : uint {
+        Active = 1 << 0,
+        Minimized = 1 << 1,
+        Maximized = 1 << 2,
+        Fullscreen = 1 << 3,
+        KeepAbove = 1 << 4,
+        KeepBelow = 1 << 5,
+        OnAllDesktops = 1 << 6,
+        DemandsAttention = 1 << 7,
+        Closeable = 1 << 8,
+        Minimizeable = 1 << 9,
+        Maximizeable = 1 << 10,
+        Fullscreenable = 1 << 11,
+        SkipTaskbar = 1 << 12,
+        SkipSwitcher = 1 << 13,
+        Shadeable = 1 << 14,
+        Shaded = 1 << 15,
+        Movable = 1 << 16,
+        Resizable = 1 << 17,
+        VirtualDesktopChangeable = 1 << 18,
+    };
+    Q_DECLARE_FLAGS(States, State)
+    Q_FLAG(States)
+
     ~PlasmaWindow() override;
 
     /**
@@ -349,6 +467,10 @@ public:
     bool skipSwitcher() const;
     /**
      * @returns The icon of the window.
+     *
+     * If the PlasmaWindowManagement uses PlasmaWindowManagement::IconFetchPolicy::OnDemand
+     * and the server announced a new icon, calling this method starts fetching it. Until
+     * it is fetched the previous icon is returned, afterwards iconChanged is emitted.
      * @see iconChanged
      **/
     QIcon icon() const;
@@ -579,6 +701,13 @@ public:
      **/
     QRect clientGeometry() const;
 
+    /**
+     * @returns All states of this PlasmaWindow.
+     * @see statesChanged
+     * @since 6.7
+     **/
+    States states() const;
+
 Q_SIGNALS:
     /**
      * The window title changed.
@@ -766,6 +895,18 @@ Q_SIGNALS:
      **/
     void clientGeometryChanged();
 
+    /**
+     * Emitted once whenever the server reports a change of the states, after the
+     * dedicated signals like activeChanged of all changed states got emitted.
+     * Connecting to this signal allows handling all state changes at once.
+     *
+     * @param oldStates The states before the change
+     * @param newStates The current states
+     * @see states
+     * @since 6.7
+     **/
+    void statesChanged(KWayland::Client::PlasmaWindow::States oldStates, KWayland::Client::PlasmaWindow::States newStates);
+
 private:
     friend class PlasmaWindowManagement;
     explicit PlasmaWindow(PlasmaWindowManagement *parent, org_kde_plasma_window *activation, quint32 internalId, const char *uuid);
@@ -894,6 +1035,8 @@ private:
     class Private;
     QScopedPointer<Private> d;
 };
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(PlasmaWindow::States)
 }
 }
 
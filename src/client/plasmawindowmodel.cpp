@@ -6,8 +6,11 @@
 #include "plasmawindowmodel.h"
 #include "plasmawindowmanagement.h"
 
+#include <QHash>
 #include <QMetaEnum>
 
+#include <algorithm>
+
 namespace KWayland
 {
 namespace Client
@@ -17,38 +20,115 @@ class Q_DECL_HIDDEN PlasmaWindowModel::Private
 public:
     Private(PlasmaWindowModel *q);
     QList<PlasmaWindow *> windows;
+    // the row of each window in windows
+    QHash<PlasmaWindow *, int> rows;
     PlasmaWindow *window = nullptr;
 
-    void addWindow(PlasmaWindow *window);
+    void addWindows(const QList<PlasmaWindow *> &newWindows);
+    void removeWindow(PlasmaWindow *window);
+    void reset();
     void dataChanged(PlasmaWindow *window, int role);
+    void emitDataChanged();
 
 private:
+    void connectWindow(PlasmaWindow *window);
+    static int roleBit(int role);
+    static int bitRole(int bit);
+
+    // changed roles per window as bit mask, see roleBit
+    QHash<PlasmaWindow *, quint64> changedRoles;
+    bool dataChangedScheduled = false;
     PlasmaWindowModel *q;
 };
 
+static_assert(PlasmaWindowModel::LastRole - PlasmaWindowModel::AppId + 2 <= 64, "The changed roles of a window do not fit into a quint64");
+
 PlasmaWindowModel::Private::Private(PlasmaWindowModel *q)
     : q(q)
 {
 }
 
-void PlasmaWindowModel::Private::addWindow(PlasmaWindow *window)
+int PlasmaWindowModel::Private::roleBit(int role)
+{
+    switch (role) {
+    case Qt::DisplayRole:
+        return 0;
+    case Qt::DecorationRole:
+        return 1;
+    default:
+        return role - AppId + 2;
+    }
+}
+
+int PlasmaWindowModel::Private::bitRole(int bit)
+{
+    switch (bit) {
+    case 0:
+        return Qt::DisplayRole;
+    case 1:
+        return Qt::DecorationRole;
+    default:
+        return bit - 2 + AppId;
+    }
+}
+
+void PlasmaWindowModel::Private::removeWindow(PlasmaWindow *window)
 {
-    if (windows.indexOf(window) != -1) {
+    auto it = rows.constFind(window);
+    if (it == rows.constEnd()) {
         return;
     }
+    const int row = *it;
+    q->beginRemoveRows(QModelIndex(), row, row);
+    windows.removeAt(row);
+    rows.erase(it);
+    for (int i = row; i < windows.count(); ++i) {
+        rows[windows.at(i)] = i;
+    }
+    changedRoles.remove(window);
+    q->endRemoveRows();
+}
+
+void PlasmaWindowModel::Private::reset()
+{
+    q->beginResetModel();
+    windows.clear();
+    rows.clear();
+    changedRoles.clear();
+    q->endResetModel();
+}
 
+void PlasmaWindowModel::Private::addWindows(const QList<PlasmaWindow *> &newWindows)
+{
+    QList<PlasmaWindow *> added;
+    added.reserve(newWindows.count());
+    for (PlasmaWindow *window : newWindows) {
+        if (!rows.contains(window)) {
+            added << window;
+        }
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+
+    // all windows are inserted at once
     const int count = windows.count();
-    q->beginInsertRows(QModelIndex(), count, count);
-    windows.append(window);
+    q->beginInsertRows(QModelIndex(), count, count + added.count() - 1);
+    for (PlasmaWindow *window : std::as_const(added)) {
+        rows.insert(window, windows.count());
+        windows.append(window);
+    }
     q->endInsertRows();
 
+    for (PlasmaWindow *window : std::as_const(added)) {
+        connectWindow(window);
+    }
+}
+
+void PlasmaWindowModel::Private::connectWindow(PlasmaWindow *window)
+{
     auto removeWindow = [window, this] {
-        const int row = windows.indexOf(window);
-        if (row != -1) {
-            q->beginRemoveRows(QModelIndex(), row, row);
-            windows.removeAt(row);
-            q->endRemoveRows();
-        }
+        this->removeWindow(window);
     };
 
     QObject::connect(window, &PlasmaWindow::unmapped, q, removeWindow);
@@ -66,82 +146,44 @@ void PlasmaWindowModel::Private::addWindow(PlasmaWindow *window)
         this->dataChanged(window, PlasmaWindowModel::AppId);
     });
 
-    QObject::connect(window, &PlasmaWindow::activeChanged, q, [window, this] {
-        this->dataChanged(window, IsActive);
-    });
-
-    QObject::connect(window, &PlasmaWindow::fullscreenableChanged, q, [window, this] {
-        this->dataChanged(window, IsFullscreenable);
-    });
-
-    QObject::connect(window, &PlasmaWindow::fullscreenChanged, q, [window, this] {
-        this->dataChanged(window, IsFullscreen);
-    });
-
-    QObject::connect(window, &PlasmaWindow::maximizeableChanged, q, [window, this] {
-        this->dataChanged(window, IsMaximizable);
-    });
-
-    QObject::connect(window, &PlasmaWindow::maximizedChanged, q, [window, this] {
-        this->dataChanged(window, IsMaximized);
-    });
-
-    QObject::connect(window, &PlasmaWindow::minimizeableChanged, q, [window, this] {
-        this->dataChanged(window, IsMinimizable);
-    });
-
-    QObject::connect(window, &PlasmaWindow::minimizedChanged, q, [window, this] {
-        this->dataChanged(window, IsMinimized);
-    });
-
-    QObject::connect(window, &PlasmaWindow::keepAboveChanged, q, [window, this] {
-        this->dataChanged(window, IsKeepAbove);
-    });
-
-    QObject::connect(window, &PlasmaWindow::keepBelowChanged, q, [window, this] {
-        this->dataChanged(window, IsKeepBelow);
+    QObject::connect(window, &PlasmaWindow::statesChanged, q, [window, this](PlasmaWindow::States oldStates, PlasmaWindow::States newStates) {
+        static const struct {
+            PlasmaWindow::State state;
+            int role;
+        } s_roles[] = {
+            {PlasmaWindow::State::Active, IsActive},
+            {PlasmaWindow::State::Fullscreenable, IsFullscreenable},
+            {PlasmaWindow::State::Fullscreen, IsFullscreen},
+            {PlasmaWindow::State::Maximizeable, IsMaximizable},
+            {PlasmaWindow::State::Maximized, IsMaximized},
+            {PlasmaWindow::State::Minimizeable, IsMinimizable},
+            {PlasmaWindow::State::Minimized, IsMinimized},
+            {PlasmaWindow::State::KeepAbove, IsKeepAbove},
+            {PlasmaWindow::State::KeepBelow, IsKeepBelow},
+            {PlasmaWindow::State::OnAllDesktops, IsOnAllDesktops},
+            {PlasmaWindow::State::DemandsAttention, IsDemandingAttention},
+            {PlasmaWindow::State::SkipTaskbar, SkipTaskbar},
+            {PlasmaWindow::State::SkipSwitcher, SkipSwitcher},
+            {PlasmaWindow::State::Shadeable, IsShadeable},
+            {PlasmaWindow::State::Shaded, IsShaded},
+            {PlasmaWindow::State::Movable, IsMovable},
+            {PlasmaWindow::State::Resizable, IsResizable},
+            {PlasmaWindow::State::VirtualDesktopChangeable, IsVirtualDesktopChangeable},
+            {PlasmaWindow::State::Closeable, IsCloseable},
+        };
+        const PlasmaWindow::States changed = oldStates ^ newStates;
+        for (const auto &r : s_roles) {
+            if (changed.testFlag(r.state)) {
+                this->dataChanged(window, r.role);
+            }
+        }
     });
 
+    // with protocol version 8 being on all desktops is derived from the virtual desktops
     QObject::connect(window, &PlasmaWindow::onAllDesktopsChanged, q, [window, this] {
         this->dataChanged(window, IsOnAllDesktops);
     });
 
-    QObject::connect(window, &PlasmaWindow::demandsAttentionChanged, q, [window, this] {
-        this->dataChanged(window, IsDemandingAttention);
-    });
-
-    QObject::connect(window, &PlasmaWindow::skipTaskbarChanged, q, [window, this] {
-        this->dataChanged(window, SkipTaskbar);
-    });
-
-    QObject::connect(window, &PlasmaWindow::skipSwitcherChanged, q, [window, this] {
-        this->dataChanged(window, SkipSwitcher);
-    });
-
-    QObject::connect(window, &PlasmaWindow::shadeableChanged, q, [window, this] {
-        this->dataChanged(window, IsShadeable);
-    });
-
-    QObject::connect(window, &PlasmaWindow::shadedChanged, q, [window, this] {
-        this->dataChanged(window, IsShaded);
-    });
-
-    QObject::connect(window, &PlasmaWindow::movableChanged, q, [window, this] {
-        this->dataChanged(window, IsMovable);
-    });
-
-    QObject::connect(window, &PlasmaWindow::resizableChanged, q, [window, this] {
-        this->dataChanged(window, IsResizable);
-    });
-
-    QObject::connect(window, &PlasmaWindow::virtualDesktopChangeableChanged, q, [window, this] {
-        this->dataChanged(window, IsVirtualDesktopChangeable);
-    });
-
-    QObject::connect(window, &PlasmaWindow::closeableChanged, q, [window, this] {
-        this->dataChanged(window, IsCloseable);
-    });
-
     QObject::connect(window, &PlasmaWindow::geometryChanged, q, [window, this] {
         this->dataChanged(window, Geometry);
     });
@@ -157,8 +199,50 @@ void PlasmaWindowModel::Private::addWindow(PlasmaWindow *window)
 
 void PlasmaWindowModel::Private::dataChanged(PlasmaWindow *window, int role)
 {
-    QModelIndex idx = q->index(windows.indexOf(window));
-    Q_EMIT q->dataChanged(idx, idx, QList<int>() << role);
+    if (!rows.contains(window)) {
+        return;
+    }
+    changedRoles[window] |= quint64(1) << roleBit(role);
+    if (dataChangedScheduled) {
+        return;
+    }
+    dataChangedScheduled = true;
+    QMetaObject::invokeMethod(
+        q,
+        [this] {
+            dataChangedScheduled = false;
+            emitDataChanged();
+        },
+        Qt::QueuedConnection);
+}
+
+void PlasmaWindowModel::Private::emitDataChanged()
+{
+    if (changedRoles.isEmpty()) {
+        return;
+    }
+    QList<std::pair<int, quint64>> changes;
+    changes.reserve(changedRoles.count());
+    for (auto it = changedRoles.constBegin(); it != changedRoles.constEnd(); ++it) {
+        changes.append({rows.value(it.key()), it.value()});
+    }
+    changedRoles.clear();
+    std::sort(changes.begin(), changes.end());
+
+    // merge consecutive rows with the same roles into one range
+    for (int first = 0; first < changes.count();) {
+        int last = first;
+        while (last + 1 < changes.count() && changes.at(last + 1).first == changes.at(last).first + 1
+               && changes.at(last + 1).second == changes.at(first).second) {
+            ++last;
+        }
+        QList<int> roles;
+        for (quint64 mask = changes.at(first).second; mask; mask &= mask - 1) {
+            roles << bitRole(qCountTrailingZeroBits(mask));
+        }
+        Q_EMIT q->dataChanged(q->index(changes.at(first).first), q->index(changes.at(last).first), roles);
+        first = last + 1;
+    }
 }
 
 PlasmaWindowModel::PlasmaWindowModel(PlasmaWindowManagement *parent)
@@ -166,18 +250,14 @@ PlasmaWindowModel::PlasmaWindowModel(PlasmaWindowManagement *parent)
     , d(new Private(this))
 {
     connect(parent, &PlasmaWindowManagement::interfaceAboutToBeReleased, this, [this] {
-        beginResetModel();
-        d->windows.clear();
-        endResetModel();
+        d->reset();
     });
 
-    connect(parent, &PlasmaWindowManagement::windowCreated, this, [this](PlasmaWindow *window) {
-        d->addWindow(window);
+    connect(parent, &PlasmaWindowManagement::windowsCreated, this, [this](const QList<PlasmaWindow *> &windows) {
+        d->addWindows(windows);
     });
 
-    for (auto it = parent->windows().constBegin(); it != parent->windows().constEnd(); ++it) {
-        d->addWindow(*it);
-    }
+    d->addWindows(parent->windows());
 }
 
 PlasmaWindowModel::~PlasmaWindowModel()
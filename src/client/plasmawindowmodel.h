@@ -29,6 +29,10 @@ class Surface;
  * The model resets when the PlasmaWindowManagement parent signals that its
  * interface is about to be destroyed.
  *
+ * Changes of the windows are collected and emitted once the event loop is
+ * reached again. Rows with the same changed roles are merged into one
+ * dataChanged signal per range of consecutive rows.
+ *
  * To use this class you can create an instance yourself, or preferably use the
  * convenience method in PlasmaWindowManagement:
  * @code
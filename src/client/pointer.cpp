@@ -7,6 +7,7 @@
 #include "surface.h"
 #include "wayland_pointer_p.h"
 // Qt
+#include <QList>
 #include <QPointF>
 #include <QPointer>
 // wayland
@@ -38,6 +39,39 @@ public:
     QPointer<Surface> enteredSurface;
     quint32 enteredSerial = 0;
 
+    // emits the accumulated events of the coalesced frames, followed by the events of the
+    // frame in progress
+    void flush();
+    // emits the accumulated events of the coalesced frames
+    void flushFrames();
+    void scheduleFlush();
+    bool coalescing = false;
+    bool historyEnabled = false;
+    bool flushScheduled = false;
+    struct AxisEvents {
+        bool changed = false;
+        quint32 time = 0;
+        qreal delta = 0;
+        bool discreteChanged = false;
+        qint32 discreteDelta = 0;
+    };
+    struct Events {
+        bool motion = false;
+        MotionSample lastMotion;
+        QList<MotionSample> motions;
+        bool axisSource = false;
+        AxisSource source = AxisSource::Wheel;
+        // indexed by Axis
+        AxisEvents axes[2];
+    };
+    void emitEvents(Events events);
+    // the merged events of the ended frames
+    Events pending;
+    bool framePending = false;
+    // the events of the frame in progress
+    Events current;
+    QList<MotionSample> motionHistory;
+
 private:
     void enter(uint32_t serial, wl_surface *surface, const QPointF &relativeToSurface);
     void leave(uint32_t serial);
@@ -97,6 +131,59 @@ void Pointer::setup(wl_pointer *pointer)
     d->setup(pointer);
 }
 
+void Pointer::Private::emitEvents(Events events)
+{
+    motionHistory = std::move(events.motions);
+    if (events.motion) {
+        Q_EMIT q->motion(events.lastMotion.position, events.lastMotion.time);
+    }
+    if (events.axisSource) {
+        Q_EMIT q->axisSourceChanged(events.source);
+    }
+    for (int i = 0; i < 2; ++i) {
+        const AxisEvents &axis = events.axes[i];
+        if (axis.discreteChanged) {
+            Q_EMIT q->axisDiscreteChanged(Axis(i), axis.discreteDelta);
+        }
+        if (axis.changed) {
+            Q_EMIT q->axisChanged(axis.time, Axis(i), axis.delta);
+        }
+    }
+    motionHistory.clear();
+}
+
+void Pointer::Private::flushFrames()
+{
+    emitEvents(std::exchange(pending, {}));
+    if (std::exchange(framePending, false)) {
+        Q_EMIT q->frame();
+    }
+}
+
+void Pointer::Private::flush()
+{
+    // the ended frames come before the events of the frame in progress
+    flushFrames();
+    emitEvents(std::exchange(current, {}));
+}
+
+void Pointer::Private::scheduleFlush()
+{
+    if (flushScheduled) {
+        return;
+    }
+    flushScheduled = true;
+    // flush once all events read together got dispatched
+    QMetaObject::invokeMethod(
+        q,
+        [this] {
+            flushScheduled = false;
+            // a frame in progress is completed by the events still to be read
+            flushFrames();
+        },
+        Qt::QueuedConnection);
+}
+
 void Pointer::Private::enterCallback(void *data, wl_pointer *pointer, uint32_t serial, wl_surface *surface, wl_fixed_t sx, wl_fixed_t sy)
 {
     auto p = reinterpret_cast<Pointer::Private *>(data);
@@ -106,6 +193,7 @@ void Pointer::Private::enterCallback(void *data, wl_pointer *pointer, uint32_t s
 
 void Pointer::Private::enter(uint32_t serial, wl_surface *surface, const QPointF &relativeToSurface)
 {
+    flush();
     enteredSurface = QPointer<Surface>(Surface::get(surface));
     enteredSerial = serial;
     Q_EMIT q->entered(serial, relativeToSurface);
@@ -121,6 +209,7 @@ void Pointer::Private::leaveCallback(void *data, wl_pointer *pointer, uint32_t s
 
 void Pointer::Private::leave(uint32_t serial)
 {
+    flush();
     enteredSurface.clear();
     Q_EMIT q->left(serial);
 }
@@ -129,7 +218,16 @@ void Pointer::Private::motionCallback(void *data, wl_pointer *pointer, uint32_t
 {
     auto p = reinterpret_cast<Pointer::Private *>(data);
     Q_ASSERT(p->pointer == pointer);
-    Q_EMIT p->q->motion(QPointF(wl_fixed_to_double(sx), wl_fixed_to_double(sy)), time);
+    const QPointF position(wl_fixed_to_double(sx), wl_fixed_to_double(sy));
+    if (!p->coalescing) {
+        Q_EMIT p->q->motion(position, time);
+        return;
+    }
+    p->current.motion = true;
+    p->current.lastMotion = {position, time};
+    if (p->historyEnabled) {
+        p->current.motions.append(p->current.lastMotion);
+    }
 }
 
 void Pointer::Private::buttonCallback(void *data, wl_pointer *pointer, uint32_t serial, uint32_t time, uint32_t button, uint32_t state)
@@ -143,6 +241,7 @@ void Pointer::Private::buttonCallback(void *data, wl_pointer *pointer, uint32_t
             return ButtonState::Pressed;
         }
     };
+    p->flush();
     Q_EMIT p->q->buttonStateChanged(serial, time, button, toState());
 }
 
@@ -150,14 +249,51 @@ void Pointer::Private::axisCallback(void *data, wl_pointer *pointer, uint32_t ti
 {
     auto p = reinterpret_cast<Pointer::Private *>(data);
     Q_ASSERT(p->pointer == pointer);
-    Q_EMIT p->q->axisChanged(time, wlAxisToPointerAxis(axis), wl_fixed_to_double(value));
+    if (!p->coalescing) {
+        Q_EMIT p->q->axisChanged(time, wlAxisToPointerAxis(axis), wl_fixed_to_double(value));
+        return;
+    }
+    AxisEvents &events = p->current.axes[int(wlAxisToPointerAxis(axis))];
+    events.changed = true;
+    events.time = time;
+    events.delta += wl_fixed_to_double(value);
 }
 
 void Pointer::Private::frameCallback(void *data, wl_pointer *pointer)
 {
     auto p = reinterpret_cast<Pointer::Private *>(data);
     Q_ASSERT(p->pointer == pointer);
-    Q_EMIT p->q->frame();
+    if (!p->coalescing) {
+        Q_EMIT p->q->frame();
+        return;
+    }
+    // merge the ended frame into the previous ones
+    Events ended = std::exchange(p->current, {});
+    Events &pending = p->pending;
+    if (ended.motion) {
+        pending.motion = true;
+        pending.lastMotion = ended.lastMotion;
+        pending.motions.append(ended.motions);
+    }
+    if (ended.axisSource) {
+        pending.axisSource = true;
+        pending.source = ended.source;
+    }
+    for (int i = 0; i < 2; ++i) {
+        const AxisEvents &from = ended.axes[i];
+        AxisEvents &to = pending.axes[i];
+        if (from.changed) {
+            to.changed = true;
+            to.time = from.time;
+            to.delta += from.delta;
+        }
+        if (from.discreteChanged) {
+            to.discreteChanged = true;
+            to.discreteDelta += from.discreteDelta;
+        }
+    }
+    p->framePending = true;
+    p->scheduleFlush();
 }
 
 void Pointer::Private::axisSourceCallback(void *data, wl_pointer *pointer, uint32_t axis_source)
@@ -182,13 +318,19 @@ void Pointer::Private::axisSourceCallback(void *data, wl_pointer *pointer, uint3
         Q_UNREACHABLE();
         break;
     }
-    Q_EMIT p->q->axisSourceChanged(source);
+    if (!p->coalescing) {
+        Q_EMIT p->q->axisSourceChanged(source);
+        return;
+    }
+    p->current.axisSource = true;
+    p->current.source = source;
 }
 
 void Pointer::Private::axisStopCallback(void *data, wl_pointer *pointer, uint32_t time, uint32_t axis)
 {
     auto p = reinterpret_cast<Pointer::Private *>(data);
     Q_ASSERT(p->pointer == pointer);
+    p->flush();
     Q_EMIT p->q->axisStopped(time, wlAxisToPointerAxis(axis));
 }
 
@@ -196,7 +338,13 @@ void Pointer::Private::axisDiscreteCallback(void *data, wl_pointer *pointer, uin
 {
     auto p = reinterpret_cast<Pointer::Private *>(data);
     Q_ASSERT(p->pointer == pointer);
-    Q_EMIT p->q->axisDiscreteChanged(wlAxisToPointerAxis(axis), discrete);
+    if (!p->coalescing) {
+        Q_EMIT p->q->axisDiscreteChanged(wlAxisToPointerAxis(axis), discrete);
+        return;
+    }
+    AxisEvents &events = p->current.axes[int(wlAxisToPointerAxis(axis))];
+    events.discreteChanged = true;
+    events.discreteDelta += discrete;
 }
 
 void Pointer::setCursor(Surface *surface, const QPoint &hotspot)
@@ -224,6 +372,42 @@ Surface *Pointer::enteredSurface() const
     return d->enteredSurface.data();
 }
 
+void Pointer::setEventCoalescing(bool enable)
+{
+    if (d->coalescing == enable) {
+        return;
+    }
+    if (!enable) {
+        d->flush();
+    }
+    d->coalescing = enable;
+}
+
+bool Pointer::isEventCoalescing() const
+{
+    return d->coalescing;
+}
+
+void Pointer::setCoalescingHistoryEnabled(bool enable)
+{
+    d->historyEnabled = enable;
+    if (!enable) {
+        d->motionHistory.clear();
+        d->pending.motions.clear();
+        d->current.motions.clear();
+    }
+}
+
+bool Pointer::isCoalescingHistoryEnabled() const
+{
+    return d->historyEnabled;
+}
+
+QList<Pointer::MotionSample> Pointer::coalescedMotions() const
+{
+    return d->motionHistory;
+}
+
 bool Pointer::isValid() const
 {
     return d->pointer.isValid();
@@ -46,6 +46,21 @@ public:
         Continuous,
         WheelTilt,
     };
+    /**
+     * One pointer location change as received from the server.
+     * @see coalescedMotions
+     * @since 6.7
+     **/
+    struct MotionSample {
+        /**
+         * Coordinates relative to the upper-left corner of the entered Surface.
+         **/
+        QPointF position;
+        /**
+         * Timestamp with millisecond granularity.
+         **/
+        quint32 time;
+    };
     explicit Pointer(QObject *parent = nullptr);
     ~Pointer() override;
 
@@ -111,6 +126,55 @@ public:
      **/
     Surface *enteredSurface();
 
+    /**
+     * Enables or disables coalescing of high-frequency events.
+     *
+     * With coalescing enabled motion, axis and axisDiscrete events are accumulated until the
+     * end of a frame. All frames dispatched together are merged and emitted once afterwards:
+     * motion is emitted with the latest position, axisChanged and axisDiscreteChanged are
+     * emitted once per Axis with the summed up deltas, followed by a single frame signal.
+     * A pointer sending with 1000 Hz thus does not cause more signal emissions than the
+     * client processes events.
+     *
+     * All other events like entered, left, buttonStateChanged and axisStopped are emitted
+     * directly after emitting the accumulated events, so the order of events is preserved.
+     *
+     * By default coalescing is disabled and every event is emitted as it arrives.
+     *
+     * @see setCoalescingHistoryEnabled
+     * @since 6.7
+     **/
+    void setEventCoalescing(bool enable);
+    /**
+     * @returns whether high-frequency events are coalesced
+     * @see setEventCoalescing
+     * @since 6.7
+     **/
+    bool isEventCoalescing() const;
+    /**
+     * Enables or disables recording all motion events which got coalesced into
+     * one motion signal. Disabled by default.
+     *
+     * @see coalescedMotions
+     * @since 6.7
+     **/
+    void setCoalescingHistoryEnabled(bool enable);
+    /**
+     * @returns whether coalesced motion events are recorded
+     * @see setCoalescingHistoryEnabled
+     * @since 6.7
+     **/
+    bool isCoalescingHistoryEnabled() const;
+    /**
+     * All motion events which got coalesced into the currently emitted motion signal,
+     * oldest first. Only valid while the signals of coalesced events are emitted and if
+     * the coalescing history is enabled.
+     *
+     * @see setCoalescingHistoryEnabled
+     * @since 6.7
+     **/
+    QList<MotionSample> coalescedMotions() const;
+
     operator wl_pointer *();
     operator wl_pointer *() const;
 
@@ -37,7 +37,11 @@
 #include "xdgshell.h"
 #include "xdgshell_p.h"
 // Qt
+#include <QByteArrayView>
 #include <QDebug>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
 // wayland
 #include "../compat/wayland-xdg-shell-v5-client-protocol.h"
 #include <wayland-appmenu-client-protocol.h>
@@ -90,7 +94,7 @@ struct SuppertedInterfaceData {
     void (Registry::*removedSignal)(quint32);
 };
 // clang-format off
-static const QMap<Registry::Interface, SuppertedInterfaceData> s_interfaces = {
+static const QHash<Registry::Interface, SuppertedInterfaceData> s_interfaces = {
     {Registry::Interface::Compositor, {
         4,
         QByteArrayLiteral("wl_compositor"),
@@ -341,6 +345,16 @@ public:
     WaylandPointer<wl_fixes, wl_fixes_destroy> fixes;
     EventQueue *queue = nullptr;
 
+    bool isInterested(Interface interface) const;
+    // one bit per Interface, 0 if interested in all interfaces
+    quint64 interestMask = 0;
+    struct LazyManager {
+        QPointer<QObject> object;
+        // the name of the global the manager is bound to
+        quint32 name;
+    };
+    QHash<Interface, LazyManager> lazyManagers;
+
 private:
     void handleAnnounce(uint32_t name, const char *interface, uint32_t version);
     void handleRemove(uint32_t name);
@@ -355,7 +369,12 @@ private:
         uint32_t name;
         uint32_t version;
     };
-    QList<InterfaceData> m_interfaces;
+    // announced globals by their name
+    QHash<uint32_t, InterfaceData> m_interfaces;
+    // names of the announced globals per Interface in the order of announcement
+    QHash<Interface, QList<uint32_t>> m_names;
+    // names of the announced globals with an Unknown interface
+    QSet<uint32_t> m_unknownNames;
     static const struct wl_registry_listener s_registryListener;
 };
 
@@ -364,6 +383,13 @@ Registry::Private::Private(Registry *q)
 {
 }
 
+static_assert(int(Registry::Interface::PlasmaActivationFeedback) < 64, "Registry::Private::interestMask cannot hold all interfaces");
+
+bool Registry::Private::isInterested(Interface interface) const
+{
+    return interestMask == 0 || (interestMask & (quint64(1) << int(interface)));
+}
+
 void Registry::Private::setup()
 {
     wl_registry_add_listener(registry, &s_registryListener, this);
@@ -389,6 +415,7 @@ void Registry::release()
     d->registry.release();
     d->callback.release();
     d->fixes.release();
+    d->lazyManagers.clear();
 }
 
 void Registry::destroy()
@@ -397,6 +424,7 @@ void Registry::destroy()
     d->registry.destroy();
     d->callback.destroy();
     d->fixes.destroy();
+    d->lazyManagers.clear();
 }
 
 void Registry::create(wl_display *display)
@@ -445,6 +473,47 @@ EventQueue *Registry::eventQueue()
     return d->queue;
 }
 
+void Registry::setInterestedInterfaces(const QList<Interface> &interfaces)
+{
+    d->interestMask = 0;
+    for (Interface interface : interfaces) {
+        d->interestMask |= quint64(1) << int(interface);
+    }
+}
+
+QList<Registry::Interface> Registry::interestedInterfaces() const
+{
+    QList<Interface> interfaces;
+    for (int i = 0; i < 64; ++i) {
+        if (d->interestMask & (quint64(1) << i)) {
+            interfaces << Interface(i);
+        }
+    }
+    return interfaces;
+}
+
+bool Registry::isInterestedIn(Interface interface) const
+{
+    return d->isInterested(interface);
+}
+
+QObject *Registry::lazyManager(Interface interface, const std::function<QObject *(quint32, quint32)> &create)
+{
+    auto it = d->lazyManagers.constFind(interface);
+    if (it != d->lazyManagers.constEnd() && it->object) {
+        return it->object;
+    }
+    const AnnouncedInterface announced = d->interface(interface);
+    if (announced.name == 0) {
+        return nullptr;
+    }
+    QObject *manager = create(announced.name, announced.version);
+    if (manager) {
+        d->lazyManagers.insert(interface, {manager, announced.name});
+    }
+    return manager;
+}
+
 #ifndef K_DOXYGEN
 const struct wl_registry_listener Registry::Private::s_registryListener = {globalAnnounce, globalRemove};
 
@@ -483,30 +552,41 @@ namespace
 {
 static Registry::Interface nameToInterface(const char *interface)
 {
-    for (auto it = s_interfaces.constBegin(); it != s_interfaces.constEnd(); ++it) {
-        if (qstrcmp(interface, it.value().name) == 0) {
-            return it.key();
+    // the views reference the names in s_interfaces, thus looking up does not allocate
+    static const QHash<QByteArrayView, Registry::Interface> s_names = [] {
+        QHash<QByteArrayView, Registry::Interface> names;
+        names.reserve(s_interfaces.size());
+        for (auto it = s_interfaces.constBegin(); it != s_interfaces.constEnd(); ++it) {
+            names.insert(QByteArrayView(it.value().name), it.key());
         }
-    }
-    return Registry::Interface::Unknown;
+        return names;
+    }();
+    return s_names.value(QByteArrayView(interface), Registry::Interface::Unknown);
 }
 }
 
 void Registry::Private::handleAnnounce(uint32_t name, const char *interface, uint32_t version)
 {
     Interface i = nameToInterface(interface);
-    if (qstrcmp(interface, wl_fixes_interface.name) == 0) {
+    if (i == Interface::Unknown && qstrcmp(interface, wl_fixes_interface.name) == 0) {
         fixes.setup(reinterpret_cast<wl_fixes *>(wl_registry_bind(registry, name, &wl_fixes_interface, 1)));
         if (queue) {
             queue->addProxy(fixes);
         }
     }
 
+    if (!isInterested(i)) {
+        // filtered before anything gets recorded or emitted
+        return;
+    }
+
     if (i == Interface::Unknown) {
         qCDebug(KWAYLAND_CLIENT) << "Unknown interface announced: " << interface << "/" << name << "/" << version;
+        m_unknownNames.insert(name);
     } else {
         qCDebug(KWAYLAND_CLIENT) << "Wayland Interface: " << interface << "/" << name << "/" << version;
-        m_interfaces.append({i, name, version});
+        m_interfaces.insert(name, {i, name, version});
+        m_names[i].append(name);
         auto it = s_interfaces.constFind(i);
         if (it != s_interfaces.end()) {
             Q_EMIT(q->*it.value().announcedSignal)(name, version);
@@ -517,12 +597,25 @@ void Registry::Private::handleAnnounce(uint32_t name, const char *interface, uin
 
 void Registry::Private::handleRemove(uint32_t name)
 {
-    auto it = std::find_if(m_interfaces.begin(), m_interfaces.end(), [name](const InterfaceData &data) {
-        return data.name == name;
-    });
+    auto it = m_interfaces.find(name);
+    if (it == m_interfaces.end() && !m_unknownNames.remove(name)) {
+        // a global which got filtered on announce
+        return;
+    }
     if (it != m_interfaces.end()) {
         InterfaceData data = *(it);
         m_interfaces.erase(it);
+        auto lit = lazyManagers.find(data.interface);
+        if (lit != lazyManagers.end() && lit->name == name) {
+            lazyManagers.erase(lit);
+        }
+        auto nit = m_names.find(data.interface);
+        if (nit != m_names.end()) {
+            nit->removeOne(name);
+            if (nit->isEmpty()) {
+                m_names.erase(nit);
+            }
+        }
         auto sit = s_interfaces.find(data.interface);
         if (sit != s_interfaces.end()) {
             Q_EMIT(q->*sit.value().removedSignal)(data.name);
@@ -533,38 +626,34 @@ void Registry::Private::handleRemove(uint32_t name)
 
 bool Registry::Private::hasInterface(Registry::Interface interface) const
 {
-    auto it = std::find_if(m_interfaces.constBegin(), m_interfaces.constEnd(), [interface](const InterfaceData &data) {
-        return data.interface == interface;
-    });
-    return it != m_interfaces.constEnd();
+    return m_names.contains(interface);
 }
 
 QList<Registry::AnnouncedInterface> Registry::Private::interfaces(Interface interface) const
 {
     QList<Registry::AnnouncedInterface> retVal;
-    for (auto it = m_interfaces.constBegin(); it != m_interfaces.constEnd(); ++it) {
-        const auto &data = *it;
-        if (data.interface == interface) {
-            retVal << AnnouncedInterface{data.name, data.version};
-        }
+    const QList<uint32_t> names = m_names.value(interface);
+    retVal.reserve(names.count());
+    for (uint32_t name : names) {
+        const InterfaceData data = m_interfaces.value(name);
+        retVal << AnnouncedInterface{data.name, data.version};
     }
     return retVal;
 }
 
 Registry::AnnouncedInterface Registry::Private::interface(Interface interface) const
 {
-    const auto all = interfaces(interface);
-    if (!all.isEmpty()) {
-        return all.last();
+    auto it = m_names.constFind(interface);
+    if (it != m_names.constEnd()) {
+        const InterfaceData data = m_interfaces.value(it->constLast());
+        return AnnouncedInterface{data.name, data.version};
     }
     return AnnouncedInterface{0, 0};
 }
 
 Registry::Interface Registry::Private::interfaceForName(quint32 name) const
 {
-    auto it = std::find_if(m_interfaces.constBegin(), m_interfaces.constEnd(), [name](const InterfaceData &data) {
-        return data.name == name;
-    });
+    auto it = m_interfaces.constFind(name);
     if (it == m_interfaces.constEnd()) {
         return Interface::Unknown;
     }
@@ -791,10 +880,8 @@ static const wl_interface *wlInterface(Registry::Interface interface)
 template<typename T>
 T *Registry::Private::bind(Registry::Interface interface, uint32_t name, uint32_t version) const
 {
-    auto it = std::find_if(m_interfaces.constBegin(), m_interfaces.constEnd(), [=](const InterfaceData &data) {
-        return data.interface == interface && data.name == name && data.version >= version;
-    });
-    if (it == m_interfaces.constEnd()) {
+    auto it = m_interfaces.constFind(name);
+    if (it == m_interfaces.constEnd() || (*it).interface != interface || (*it).version < version) {
         qCDebug(KWAYLAND_CLIENT) << "Don't have interface " << int(interface) << "with name " << name << "and minimum version" << version;
         return nullptr;
     }
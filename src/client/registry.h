@@ -10,6 +10,8 @@
 #include <QHash>
 #include <QObject>
 
+#include <functional>
+
 #include "KWayland/Client/kwaylandclient_export.h"
 
 struct wl_compositor;
@@ -266,6 +268,58 @@ public:
      **/
     QList<AnnouncedInterface> interfaces(Interface interface) const;
 
+    /**
+     * Declares the well-known @p interfaces the client is interested in.
+     *
+     * Globals of any other interface are ignored by the Registry: they are not recorded and
+     * neither the dedicated announced and removed signals nor interfaceAnnounced and
+     * interfaceRemoved are emitted for them. Interfaces unknown to the Registry are only reported
+     * through interfaceAnnounced and interfaceRemoved if @p interfaces contains
+     * Interface::Unknown.
+     *
+     * This allows short-lived clients to skip the work for all the globals they never use.
+     * The interest set should be declared before calling setup. An empty list, which is the
+     * default, means that the client is interested in all interfaces.
+     *
+     * @see interestedInterfaces
+     * @since 6.7
+     **/
+    void setInterestedInterfaces(const QList<Interface> &interfaces);
+    /**
+     * @returns The well-known interfaces the client is interested in, an empty list if interested in all interfaces
+     * @see setInterestedInterfaces
+     * @since 6.7
+     **/
+    QList<Interface> interestedInterfaces() const;
+    /**
+     * @returns @c true if globals of @p interface are handled by the Registry
+     * @see setInterestedInterfaces
+     * @since 6.7
+     **/
+    bool isInterestedIn(Interface interface) const;
+
+    /**
+     * Provides the manager object for the well-known @p interface, creating it on first use.
+     *
+     * The first call creates the manager with @p createMethod for the last announced global of
+     * @p interface, subsequent calls return the same object. This allows binding managers
+     * lazily when they are actually needed instead of creating every manager during startup:
+     *
+     * @code
+     * Compositor *compositor = registry->lazyManager(Registry::Interface::Compositor, &Registry::createCompositor);
+     * @endcode
+     *
+     * The manager is a child of the Registry. Once its global gets removed, the next call
+     * creates a new manager for another announced global of @p interface, if any.
+     *
+     * @param interface The well-known interface for which the manager should be provided
+     * @param createMethod The create method matching @p interface, e.g. createCompositor
+     * @returns The manager or @c null if @p interface has not been announced
+     * @since 6.7
+     **/
+    template<typename T>
+    T *lazyManager(Interface interface, T *(Registry::*createMethod)(quint32, quint32, QObject *));
+
     /**
      * @name Low-level bind methods for global interfaces.
      **/
@@ -1508,10 +1562,19 @@ Q_SIGNALS:
     void registryDestroyed();
 
 private:
+    QObject *lazyManager(Interface interface, const std::function<QObject *(quint32, quint32)> &create);
     class Private;
     QScopedPointer<Private> d;
 };
 
+template<typename T>
+inline T *Registry::lazyManager(Interface interface, T *(Registry::*createMethod)(quint32, quint32, QObject *))
+{
+    return static_cast<T *>(lazyManager(interface, [this, createMethod](quint32 name, quint32 version) -> QObject * {
+        return (this->*createMethod)(name, version, this);
+    }));
+}
+
 }
 }
 
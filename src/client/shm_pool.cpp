@@ -10,7 +10,14 @@
 #include "wayland_pointer_p.h"
 // Qt
 #include <QDebug>
+#include <QHash>
 #include <QImage>
+#include <QMap>
+#include <QRegion>
+// STL
+#include <algorithm>
+#include <limits>
+#include <optional>
 // system
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -22,27 +29,100 @@ namespace KWayland
 {
 namespace Client
 {
+namespace
+{
+struct BufferKey {
+    QSize size;
+    int32_t stride;
+    Buffer::Format format;
+    bool operator==(const BufferKey &other) const = default;
+};
+
+size_t qHash(const BufferKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.size.width(), key.size.height(), key.stride, int(key.format));
+}
+
+// allocations are aligned to a cache line
+constexpr int32_t s_alignment = 64;
+
+int32_t alignedSize(int32_t byteCount)
+{
+    return (byteCount + s_alignment - 1) & ~(s_alignment - 1);
+}
+
+int32_t allocationSize(const QSize &size, int32_t stride)
+{
+    return alignedSize(size.height() * stride);
+}
+
+// number of frames per content for which the damage is remembered
+constexpr int s_damageHistorySize = 4;
+// number of contents for which a damage history is kept
+constexpr int s_maxDamageHistories = 16;
+
+struct DamageHistory {
+    struct Frame {
+        quint64 serial;
+        quint64 previous;
+        QRegion damage;
+    };
+    // the most recent frames, newest last
+    QList<Frame> frames;
+};
+
+// the initial size of a pool
+constexpr int32_t s_initialSize = 1024;
+// address space mapped up front, so that growing the pool does not move existing Buffers
+constexpr int32_t s_reservedSize = sizeof(void *) == 8 ? (1 << 30) : 0;
+}
+
 class Q_DECL_HIDDEN ShmPool::Private
 {
 public:
     Private(ShmPool *q);
     bool createPool();
     bool resizePool(int32_t newSize);
-    QList<QSharedPointer<Buffer>>::iterator getBuffer(const QSize &size, int32_t stride, Buffer::Format format);
+    bool growPool(int32_t length);
+    bool mapPool(int32_t length);
+    QSharedPointer<Buffer> getBuffer(const QSize &size, int32_t stride, Buffer::Format format, quint64 contentId = 0);
+    QSharedPointer<Buffer>
+    createBuffer(const QSize &size, int32_t stride, const void *src, Buffer::Format format, quint64 contentId, const QRegion &damage);
+    DamageHistory &damageHistory(quint64 contentId);
+    static void formatCallback(void *data, wl_shm *shm, uint32_t format);
+    int32_t allocate(int32_t length);
+    int32_t deallocate(int32_t offset, int32_t length);
+    void destroyBuffer(const QSharedPointer<Buffer> &buffer);
+    bool reclaimIdleBuffers(int32_t length);
+    QList<QSharedPointer<Buffer>> idleBuffers() const;
     WaylandPointer<wl_shm, wl_shm_destroy> shm;
     WaylandPointer<wl_shm_pool, wl_shm_pool_destroy> pool;
     void *poolData = nullptr;
     int fd = -1;
-    int32_t size = 1024;
+    int32_t size = s_initialSize;
+    // length of the mapping at poolData, might exceed the size of the pool
+    int32_t mappedSize = 0;
     bool valid = false;
-    int offset = 0;
-    QList<QSharedPointer<Buffer>> buffers;
+    // unused regions of the pool, offset to length, adjacent regions are always merged
+    QMap<int32_t, int32_t> freeRegions;
+    QMultiHash<BufferKey, QSharedPointer<Buffer>> buffers;
+    // what changed between the frames copied into Buffers, per content
+    QHash<quint64, DamageHistory> damageHistories;
+    quint64 frameSerial = 0;
+    // formats announced by the server, ARGB32 and RGB32 are always supported
+    QList<Buffer::Format> formats = {Buffer::Format::ARGB32, Buffer::Format::RGB32};
     EventQueue *queue = nullptr;
 
+    static const wl_shm_listener s_listener;
+
 private:
     ShmPool *q;
 };
 
+#ifndef K_DOXYGEN
+const wl_shm_listener ShmPool::Private::s_listener = {formatCallback};
+#endif
+
 ShmPool::Private::Private(ShmPool *q)
     : q(q)
 {
@@ -63,7 +143,7 @@ void ShmPool::release()
 {
     d->buffers.clear();
     if (d->poolData) {
-        munmap(d->poolData, d->size);
+        munmap(d->poolData, d->mappedSize);
         d->poolData = nullptr;
     }
     if (d->fd != -1) {
@@ -73,17 +153,19 @@ void ShmPool::release()
     d->pool.release();
     d->shm.release();
     d->valid = false;
-    d->offset = 0;
+    d->freeRegions.clear();
+    d->damageHistories.clear();
+    d->formats = {Buffer::Format::ARGB32, Buffer::Format::RGB32};
 }
 
 void ShmPool::destroy()
 {
-    for (auto b : d->buffers) {
+    for (const auto &b : std::as_const(d->buffers)) {
         b->d->destroy();
     }
     d->buffers.clear();
     if (d->poolData) {
-        munmap(d->poolData, d->size);
+        munmap(d->poolData, d->mappedSize);
         d->poolData = nullptr;
     }
     if (d->fd != -1) {
@@ -93,7 +175,9 @@ void ShmPool::destroy()
     d->pool.destroy();
     d->shm.destroy();
     d->valid = false;
-    d->offset = 0;
+    d->freeRegions.clear();
+    d->damageHistories.clear();
+    d->formats = {Buffer::Format::ARGB32, Buffer::Format::RGB32};
 }
 
 void ShmPool::setup(wl_shm *shm)
@@ -101,6 +185,7 @@ void ShmPool::setup(wl_shm *shm)
     Q_ASSERT(shm);
     Q_ASSERT(!d->shm);
     d->shm.setup(shm);
+    wl_shm_add_listener(shm, &Private::s_listener, d.data());
     d->valid = d->createPool();
 }
 
@@ -145,13 +230,33 @@ bool ShmPool::Private::createPool()
         qCDebug(KWAYLAND_CLIENT) << "Could not set size for Shm pool file";
         return false;
     }
-    poolData = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const bool mapped = mapPool(std::max(size, s_reservedSize));
     pool.setup(wl_shm_create_pool(shm, fd, size));
 
-    if (poolData == MAP_FAILED || !pool) {
+    if (!mapped || !pool) {
         qCDebug(KWAYLAND_CLIENT) << "Creating Shm pool failed";
         return false;
     }
+    freeRegions.clear();
+    freeRegions.insert(0, size);
+    return true;
+}
+
+bool ShmPool::Private::mapPool(int32_t length)
+{
+    // pages beyond the end of the file become accessible as soon as the file grows
+    poolData = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (poolData == MAP_FAILED && length > size) {
+        // could not reserve the address space, only map the pool itself
+        length = size;
+        poolData = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (poolData == MAP_FAILED) {
+        poolData = nullptr;
+        mappedSize = 0;
+        return false;
+    }
+    mappedSize = length;
     return true;
 }
 
@@ -162,122 +267,460 @@ bool ShmPool::Private::resizePool(int32_t newSize)
         return false;
     }
     wl_shm_pool_resize(pool, newSize);
-    munmap(poolData, size);
-    poolData = mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int32_t oldSize = size;
     size = newSize;
-    if (poolData == MAP_FAILED) {
-        qCDebug(KWAYLAND_CLIENT) << "Resizing Shm pool failed";
-        return false;
+    if (newSize > mappedSize) {
+        // outgrew the mapping, the pool has to be mapped at a new address
+        munmap(poolData, mappedSize);
+        if (!mapPool(int32_t(std::min<qint64>(qint64(newSize) * 2, std::numeric_limits<int32_t>::max())))) {
+            qCDebug(KWAYLAND_CLIENT) << "Resizing Shm pool failed";
+            return false;
+        }
+        deallocate(oldSize, newSize - oldSize);
+        Q_EMIT q->poolResized();
+        return true;
     }
-    Q_EMIT q->poolResized();
+    deallocate(oldSize, newSize - oldSize);
     return true;
 }
 
+bool ShmPool::Private::growPool(int32_t length)
+{
+    // a free region at the end of the pool can be extended
+    int32_t tail = 0;
+    if (!freeRegions.isEmpty()) {
+        auto last = std::prev(freeRegions.end());
+        if (last.key() + last.value() == size) {
+            tail = last.value();
+        }
+    }
+    const qint64 required = qint64(size) + length - tail;
+    if (required > std::numeric_limits<int32_t>::max()) {
+        qCDebug(KWAYLAND_CLIENT) << "Shm pool cannot grow beyond" << std::numeric_limits<int32_t>::max() << "bytes";
+        return false;
+    }
+    // grow geometrically so that a series of growing Buffers only causes a few resizes
+    const qint64 doubled = std::min<qint64>(qint64(size) * 2, std::numeric_limits<int32_t>::max() & ~(s_alignment - 1));
+    return resizePool(int32_t(std::max(required, doubled)));
+}
+
+int32_t ShmPool::Private::allocate(int32_t length)
+{
+    // best fit: the smallest free region the allocation fits into
+    auto best = freeRegions.end();
+    for (auto it = freeRegions.begin(); it != freeRegions.end(); ++it) {
+        if (it.value() < length) {
+            continue;
+        }
+        if (best == freeRegions.end() || it.value() < best.value()) {
+            best = it;
+            if (best.value() == length) {
+                break;
+            }
+        }
+    }
+    if (best == freeRegions.end()) {
+        return -1;
+    }
+    const int32_t offset = best.key();
+    const int32_t remaining = best.value() - length;
+    freeRegions.erase(best);
+    if (remaining > 0) {
+        freeRegions.insert(offset + length, remaining);
+    }
+    return offset;
+}
+
+int32_t ShmPool::Private::deallocate(int32_t offset, int32_t length)
+{
+    // merge with the adjacent free regions, returns the length of the resulting region
+    auto next = freeRegions.lowerBound(offset);
+    if (next != freeRegions.end() && offset + length == next.key()) {
+        length += next.value();
+        next = freeRegions.erase(next);
+    }
+    if (next != freeRegions.begin()) {
+        auto previous = std::prev(next);
+        if (previous.key() + previous.value() == offset) {
+            previous.value() += length;
+            return previous.value();
+        }
+    }
+    freeRegions.insert(offset, length);
+    return length;
+}
+
+void ShmPool::Private::destroyBuffer(const QSharedPointer<Buffer> &buffer)
+{
+    // keep the Buffer alive until it is removed from the index
+    const QSharedPointer<Buffer> b = buffer;
+    deallocate(b->d->offset, allocationSize(b->size(), b->stride()));
+    buffers.remove(BufferKey{b->size(), b->stride(), b->format()}, b);
+}
+
+QList<QSharedPointer<Buffer>> ShmPool::Private::idleBuffers() const
+{
+    QList<QSharedPointer<Buffer>> idle;
+    for (const auto &buffer : buffers) {
+        if (buffer->isReleased() && !buffer->isUsed()) {
+            idle << buffer;
+        }
+    }
+    return idle;
+}
+
+bool ShmPool::Private::reclaimIdleBuffers(int32_t length)
+{
+    // destroy Buffers the server released and nobody uses until a large enough region is free
+    const auto idle = idleBuffers();
+    for (const auto &buffer : idle) {
+        destroyBuffer(buffer);
+        for (auto it = freeRegions.cbegin(); it != freeRegions.cend(); ++it) {
+            if (it.value() >= length) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 namespace
 {
-static Buffer::Format toBufferFormat(const QImage &image)
+static Buffer::Format toBufferFormat(const QImage &image, const QList<Buffer::Format> &supportedFormats)
 {
+    std::optional<Buffer::Format> format;
     switch (image.format()) {
     case QImage::Format_ARGB32_Premultiplied:
-        return Buffer::Format::ARGB32;
+        format = Buffer::Format::ARGB32;
+        break;
     case QImage::Format_RGB32:
-        return Buffer::Format::RGB32;
+        format = Buffer::Format::RGB32;
+        break;
     case QImage::Format_ARGB32:
         qCWarning(KWAYLAND_CLIENT) << "Unsupported image format: " << image.format() << ". expect slow performance. Use QImage::Format_ARGB32_Premultiplied";
         return Buffer::Format::ARGB32;
+    case QImage::Format_RGB16:
+        format = Buffer::Format::RGB16;
+        break;
+    case QImage::Format_RGBA8888_Premultiplied:
+        format = Buffer::Format::RGBA8888;
+        break;
+    case QImage::Format_RGBX8888:
+        format = Buffer::Format::RGBX8888;
+        break;
+    case QImage::Format_A2RGB30_Premultiplied:
+        format = Buffer::Format::A2RGB30;
+        break;
+    case QImage::Format_RGB30:
+        format = Buffer::Format::RGB30;
+        break;
+    case QImage::Format_A2BGR30_Premultiplied:
+        format = Buffer::Format::A2BGR30;
+        break;
+    case QImage::Format_BGR30:
+        format = Buffer::Format::BGR30;
+        break;
+    case QImage::Format_RGBA64_Premultiplied:
+        format = Buffer::Format::RGBA64;
+        break;
+    case QImage::Format_RGBX64:
+        format = Buffer::Format::RGBX64;
+        break;
     default:
-        qCWarning(KWAYLAND_CLIENT) << "Unsupported image format: " << image.format() << ". expect slow performance.";
+        break;
+    }
+    if (format && supportedFormats.contains(*format)) {
+        return *format;
+    }
+    qCWarning(KWAYLAND_CLIENT) << "Unsupported image format: " << image.format() << ". expect slow performance.";
+    return Buffer::Format::ARGB32;
+}
+
+static wl_shm_format toWaylandFormat(Buffer::Format format)
+{
+    switch (format) {
+    case Buffer::Format::ARGB32:
+        return WL_SHM_FORMAT_ARGB8888;
+    case Buffer::Format::RGB32:
+        return WL_SHM_FORMAT_XRGB8888;
+    case Buffer::Format::RGB16:
+        return WL_SHM_FORMAT_RGB565;
+    case Buffer::Format::RGBA8888:
+        return WL_SHM_FORMAT_ABGR8888;
+    case Buffer::Format::RGBX8888:
+        return WL_SHM_FORMAT_XBGR8888;
+    case Buffer::Format::A2RGB30:
+        return WL_SHM_FORMAT_ARGB2101010;
+    case Buffer::Format::RGB30:
+        return WL_SHM_FORMAT_XRGB2101010;
+    case Buffer::Format::A2BGR30:
+        return WL_SHM_FORMAT_ABGR2101010;
+    case Buffer::Format::BGR30:
+        return WL_SHM_FORMAT_XBGR2101010;
+    case Buffer::Format::RGBA64:
+        return WL_SHM_FORMAT_ABGR16161616;
+    case Buffer::Format::RGBX64:
+        return WL_SHM_FORMAT_XBGR16161616;
+    }
+    abort();
+}
+
+static std::optional<Buffer::Format> fromWaylandFormat(uint32_t format)
+{
+    switch (format) {
+    case WL_SHM_FORMAT_ARGB8888:
         return Buffer::Format::ARGB32;
+    case WL_SHM_FORMAT_XRGB8888:
+        return Buffer::Format::RGB32;
+    case WL_SHM_FORMAT_RGB565:
+        return Buffer::Format::RGB16;
+    case WL_SHM_FORMAT_ABGR8888:
+        return Buffer::Format::RGBA8888;
+    case WL_SHM_FORMAT_XBGR8888:
+        return Buffer::Format::RGBX8888;
+    case WL_SHM_FORMAT_ARGB2101010:
+        return Buffer::Format::A2RGB30;
+    case WL_SHM_FORMAT_XRGB2101010:
+        return Buffer::Format::RGB30;
+    case WL_SHM_FORMAT_ABGR2101010:
+        return Buffer::Format::A2BGR30;
+    case WL_SHM_FORMAT_XBGR2101010:
+        return Buffer::Format::BGR30;
+    case WL_SHM_FORMAT_ABGR16161616:
+        return Buffer::Format::RGBA64;
+    case WL_SHM_FORMAT_XBGR16161616:
+        return Buffer::Format::RGBX64;
+    default:
+        return std::nullopt;
     }
 }
 }
 
+void ShmPool::Private::formatCallback(void *data, wl_shm *shm, uint32_t format)
+{
+    auto p = reinterpret_cast<ShmPool::Private *>(data);
+    Q_ASSERT(p->shm == shm);
+    const auto bufferFormat = fromWaylandFormat(format);
+    if (!bufferFormat || p->formats.contains(*bufferFormat)) {
+        return;
+    }
+    p->formats << *bufferFormat;
+}
+
+namespace
+{
+quint64 imageContentId(const QImage &image)
+{
+    // the serial number of the image data, stays the same when the image gets modified
+    return quint64(image.cacheKey()) & ~quint64(0xffffffff);
+}
+}
+
 Buffer::Ptr ShmPool::createBuffer(const QImage &image)
+{
+    return createBuffer(image, QRegion(image.rect()));
+}
+
+Buffer::Ptr ShmPool::createBuffer(const QImage &image, const QRegion &damage)
 {
     if (image.isNull() || !d->valid) {
         return QWeakPointer<Buffer>();
     }
-    auto format = toBufferFormat(image);
-    auto it = d->getBuffer(image.size(), image.bytesPerLine(), format);
-    if (it == d->buffers.end()) {
-        return QWeakPointer<Buffer>();
-    }
-    if (format == Buffer::Format::ARGB32 && image.format() != QImage::Format_ARGB32_Premultiplied) {
-        auto imageCopy = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
-        (*it)->copy(imageCopy.bits());
-    } else {
-        (*it)->copy(image.bits());
+    auto format = toBufferFormat(image, d->formats);
+    const QImage::Format imageFormat = Buffer::Private::toImageFormat(format);
+    if (image.format() != imageFormat) {
+        auto imageCopy = image.convertToFormat(imageFormat);
+        return d->createBuffer(imageCopy.size(), imageCopy.bytesPerLine(), imageCopy.constBits(), format, imageContentId(image), damage);
     }
-    return QWeakPointer<Buffer>(*it);
+    return d->createBuffer(image.size(), image.bytesPerLine(), image.constBits(), format, imageContentId(image), damage);
 }
 
 Buffer::Ptr ShmPool::createBuffer(const QSize &size, int32_t stride, const void *src, Buffer::Format format)
+{
+    return createBuffer(size, stride, src, QRegion(QRect(QPoint(0, 0), size)), format);
+}
+
+Buffer::Ptr ShmPool::createBuffer(const QSize &size, int32_t stride, const void *src, const QRegion &damage, Buffer::Format format)
 {
     if (size.isEmpty() || !d->valid) {
         return QWeakPointer<Buffer>();
     }
-    auto it = d->getBuffer(size, stride, format);
-    if (it == d->buffers.end()) {
-        return QWeakPointer<Buffer>();
-    }
-    (*it)->copy(src);
-    return QWeakPointer<Buffer>(*it);
+    return d->createBuffer(size, stride, src, format, quintptr(src), damage);
 }
 
-namespace
-{
-static wl_shm_format toWaylandFormat(Buffer::Format format)
+QSharedPointer<Buffer>
+ShmPool::Private::createBuffer(const QSize &size, int32_t stride, const void *src, Buffer::Format format, quint64 contentId, const QRegion &damage)
 {
-    switch (format) {
-    case Buffer::Format::ARGB32:
-        return WL_SHM_FORMAT_ARGB8888;
-    case Buffer::Format::RGB32:
-        return WL_SHM_FORMAT_XRGB8888;
+    auto buffer = getBuffer(size, stride, format, contentId);
+    if (!buffer) {
+        return {};
     }
-    abort();
+    DamageHistory &history = damageHistory(contentId);
+    const quint64 serial = ++frameSerial;
+    const quint64 previous = history.frames.isEmpty() ? 0 : history.frames.constLast().serial;
+
+    // the Buffer only needs the changes since the frame it already holds
+    const quint64 bufferSerial = buffer->d->contentId == contentId ? buffer->d->contentSerial : 0;
+    bool partial = false;
+    QRegion region = damage;
+    if (bufferSerial != 0) {
+        if (bufferSerial == previous) {
+            partial = true;
+        } else {
+            for (auto it = history.frames.crbegin(); it != history.frames.crend(); ++it) {
+                region += it->damage;
+                if (it->previous == bufferSerial) {
+                    partial = true;
+                    break;
+                }
+            }
+        }
+    }
+    if (partial) {
+        buffer->copy(src, region);
+    } else {
+        buffer->copy(src);
+    }
+
+    history.frames.append(DamageHistory::Frame{serial, previous, damage});
+    if (history.frames.size() > s_damageHistorySize) {
+        history.frames.removeFirst();
+    }
+    buffer->d->contentId = contentId;
+    buffer->d->contentSerial = serial;
+    return buffer;
 }
+
+DamageHistory &ShmPool::Private::damageHistory(quint64 contentId)
+{
+    auto it = damageHistories.find(contentId);
+    if (it != damageHistories.end()) {
+        return *it;
+    }
+    if (damageHistories.size() >= s_maxDamageHistories) {
+        // forget the content which was not updated for the longest time
+        auto oldest = damageHistories.begin();
+        for (auto candidate = damageHistories.begin(); candidate != damageHistories.end(); ++candidate) {
+            if (candidate->frames.constLast().serial < oldest->frames.constLast().serial) {
+                oldest = candidate;
+            }
+        }
+        damageHistories.erase(oldest);
+    }
+    return *damageHistories.insert(contentId, DamageHistory());
 }
 
 Buffer::Ptr ShmPool::getBuffer(const QSize &size, int32_t stride, Buffer::Format format)
 {
-    auto it = d->getBuffer(size, stride, format);
-    if (it == d->buffers.end()) {
-        return QWeakPointer<Buffer>();
+    auto buffer = d->getBuffer(size, stride, format);
+    if (buffer) {
+        // the content is up to the caller
+        buffer->d->contentId = 0;
+        buffer->d->contentSerial = 0;
     }
-    return QWeakPointer<Buffer>(*it);
+    return QWeakPointer<Buffer>(buffer);
 }
 
-QList<QSharedPointer<Buffer>>::iterator ShmPool::Private::getBuffer(const QSize &s, int32_t stride, Buffer::Format format)
+QSharedPointer<Buffer> ShmPool::Private::getBuffer(const QSize &s, int32_t stride, Buffer::Format format, quint64 contentId)
 {
-    for (auto it = buffers.begin(); it != buffers.end(); ++it) {
-        auto buffer = *it;
+    const BufferKey key{s, stride, format};
+    const auto [begin, end] = std::as_const(buffers).equal_range(key);
+    QSharedPointer<Buffer> candidate;
+    for (auto it = begin; it != end; ++it) {
+        const auto &buffer = it.value();
         if (!buffer->isReleased() || buffer->isUsed()) {
             continue;
         }
-        if (buffer->size() != s || buffer->stride() != stride || buffer->format() != format) {
-            continue;
+        if (!candidate) {
+            candidate = buffer;
         }
-        buffer->setReleased(false);
-        return it;
-    }
-    const int32_t byteCount = s.height() * stride;
-    if (offset + byteCount > size) {
-        if (!resizePool(size + byteCount)) {
-            return buffers.end();
+        // prefer the Buffer holding the most recent frame of the same content
+        if (contentId != 0 && buffer->d->contentId == contentId
+            && (candidate->d->contentId != contentId || buffer->d->contentSerial > candidate->d->contentSerial)) {
+            candidate = buffer;
         }
     }
+    if (candidate) {
+        candidate->setReleased(false);
+        return candidate;
+    }
     // we don't have a buffer which we could reuse - need to create a new one
+    const int32_t length = allocationSize(s, stride);
+    int32_t offset = allocate(length);
+    if (offset < 0 && reclaimIdleBuffers(length)) {
+        offset = allocate(length);
+    }
+    if (offset < 0) {
+        if (!growPool(length)) {
+            return {};
+        }
+        offset = allocate(length);
+        if (offset < 0) {
+            return {};
+        }
+    }
     wl_buffer *native = wl_shm_pool_create_buffer(pool, offset, s.width(), s.height(), stride, toWaylandFormat(format));
     if (!native) {
-        return buffers.end();
+        deallocate(offset, length);
+        return {};
     }
     if (queue) {
         queue->addProxy(native);
     }
-    Buffer *buffer = new Buffer(q, native, s, stride, offset, format);
-    offset += byteCount;
-    auto it = buffers.insert(buffers.end(), QSharedPointer<Buffer>(buffer));
-    return it;
+    QSharedPointer<Buffer> buffer(new Buffer(q, native, s, stride, offset, format));
+    buffers.insert(key, buffer);
+    return buffer;
+}
+
+void ShmPool::compact()
+{
+    if (!d->valid) {
+        return;
+    }
+    const auto idle = d->idleBuffers();
+    for (const auto &buffer : idle) {
+        d->destroyBuffer(buffer);
+    }
+    if (!d->buffers.isEmpty()) {
+        return;
+    }
+    // nothing references the pool any more, start over with a minimal pool
+    if (d->size <= s_initialSize) {
+        return;
+    }
+    munmap(d->poolData, d->mappedSize);
+    d->poolData = nullptr;
+    close(d->fd);
+    d->fd = -1;
+    d->pool.release();
+    d->size = s_initialSize;
+    d->valid = d->createPool();
+    Q_EMIT poolResized();
+}
+
+bool ShmPool::reserve(int32_t byteCount)
+{
+    if (!d->valid || byteCount > (std::numeric_limits<int32_t>::max() & ~(s_alignment - 1))) {
+        return false;
+    }
+    // the same size getBuffer allocates
+    const int32_t length = alignedSize(byteCount);
+    for (auto it = d->freeRegions.cbegin(); it != d->freeRegions.cend(); ++it) {
+        if (it.value() >= length) {
+            return true;
+        }
+    }
+    return d->growPool(length);
+}
+
+QList<Buffer::Format> ShmPool::formats() const
+{
+    return d->formats;
+}
+
+bool ShmPool::supportsFormat(Buffer::Format format) const
+{
+    return d->formats.contains(format);
 }
 
 bool ShmPool::isValid() const
@@ -6,12 +6,14 @@
 #ifndef WAYLAND_SHM_POOL_H
 #define WAYLAND_SHM_POOL_H
 
+#include <QList>
 #include <QObject>
 
 #include "KWayland/Client/kwaylandclient_export.h"
 #include "buffer.h"
 
 class QImage;
+class QRegion;
 class QSize;
 
 struct wl_shm;
@@ -58,7 +60,8 @@ class EventQueue;
  * The ShmPool can provide Buffers for different purposes. One can create a Buffer
  * from an existing QImage. This will use a Buffer with same size, stride and image
  * format as the QImage and <b>copy</b> the content of the QImage into the Buffer.
- * The memory is <b>not</b> shared:
+ * If the Wayland server does not support a matching format, the QImage is converted
+ * first, see formats(). The memory is <b>not</b> shared:
  * @code
  * QImage image(24, 24, QImage::Format_ARG32);
  * image.fill(Qt::transparent);
@@ -88,6 +91,14 @@ class EventQueue;
  * image.fill(Qt::black);
  * @endcode
  *
+ * Buffer::image() provides such a QImage directly, which allows to paint into the shared
+ * memory with QPainter instead of painting into a QImage and copying it with createBuffer:
+ * @code
+ * Buffer::Ptr buffer = s->getBuffer(size, stride, Buffer::Format::ARGB32);
+ * QImage image = buffer.toStrongRef()->image();
+ * QPainter painter(&image);
+ * @endcode
+ *
  * A Buffer can be attached to a Surface:
  * @code
  * Compositor *c = registry.createCompositor(name, version);
@@ -106,9 +117,19 @@ class EventQueue;
  * @endcode
  *
  * This is also important for the case that the shared memory pool needs to be resized.
- * The ShmPool will automatically resize if it cannot provide a new Buffer. During the resize
- * all existing Buffers are unmapped and any shared objects must be recreated. The ShmPool emits
- * the signal poolResized() after the pool got resized.
+ * The ShmPool will automatically resize if it cannot provide a new Buffer. The pool grows
+ * geometrically and is mapped into a large reserved address range, so that a resize normally
+ * keeps all existing Buffers at their address. Only if the pool outgrows that range it has to
+ * be mapped again. In that case all existing Buffers are unmapped and any shared objects must
+ * be recreated. The ShmPool emits the signal poolResized() after the pool got mapped again.
+ * To avoid resizing the pool several times while creating the Buffers for a frame, the
+ * required memory can be requested up front with reserve().
+ *
+ * Memory of the pool is handed out to new Buffers from a list of free regions, using the
+ * smallest region the Buffer fits into. Before the pool grows, Buffers which are released
+ * by the server and not used get destroyed to make their memory available again. Adjacent
+ * free regions are merged. The pool can be shrunk with compact() once no Buffers are in use
+ * anymore.
  *
  * @see Buffer
  **/
@@ -195,6 +216,40 @@ public:
      * @see getBuffer
      **/
     Buffer::Ptr createBuffer(const QSize &size, int32_t stride, const void *src, Buffer::Format format = Buffer::Format::ARGB32);
+    /**
+     * Provides a Buffer with the same size, stride and format as @p image, like
+     * createBuffer(const QImage &), but only copies what changed.
+     *
+     * The @p damage describes the area of @p image which changed since the previous time it
+     * was passed to createBuffer. The ShmPool remembers which frame of the @p image each Buffer
+     * holds and the damage of the last frames. If the provided Buffer holds a recent frame of
+     * the same image only the changed lines and spans are copied, otherwise the complete image
+     * is copied. The same @p damage should be passed to Surface::damageBuffer when attaching
+     * the Buffer.
+     *
+     * @param image The image which should be copied into the Buffer
+     * @param damage The area of @p image which changed since the previous call
+     * @return Buffer with copied content of @p image in success case, a @c null Buffer::Ptr otherwise
+     * @see Buffer::copy
+     * @since 6.7
+     **/
+    Buffer::Ptr createBuffer(const QImage &image, const QRegion &damage);
+    /**
+     * Provides a Buffer with @p size, @p stride and @p format, copying only what changed.
+     *
+     * Like createBuffer(const QImage &, const QRegion &), with the memory location @p src
+     * identifying the content. The @p damage describes the area which changed since the
+     * previous time @p src was passed to createBuffer.
+     *
+     * @param size The requested size for the Buffer
+     * @param stride The requested stride for the Buffer
+     * @param src The source memory location to copy from
+     * @param damage The area which changed since the previous call
+     * @param format The requested format for the Buffer
+     * @return Buffer with copied content of @p src in success case, a @c null Buffer::Ptr otherwise
+     * @since 6.7
+     **/
+    Buffer::Ptr createBuffer(const QSize &size, int32_t stride, const void *src, const QRegion &damage, Buffer::Format format = Buffer::Format::ARGB32);
     void *poolAddress() const;
     /**
      * Provides a Buffer with @p size, @p stride and @p format.
@@ -210,11 +265,46 @@ public:
      * @see createBuffer
      **/
     Buffer::Ptr getBuffer(const QSize &size, int32_t stride, Buffer::Format format = Buffer::Format::ARGB32);
+    /**
+     * Destroys all Buffers which are released by the server and not marked as used, making
+     * their memory available for new Buffers. If afterwards no Buffer is left the shared
+     * memory pool is recreated with its initial size and poolResized() is emitted.
+     *
+     * @since 6.7
+     **/
+    void compact();
+    /**
+     * Ensures that a Buffer of @p byteCount bytes can be provided without resizing the pool.
+     * If needed the pool is grown by a single resize. This allows to combine the growth for
+     * several Buffers, e.g. all Buffers needed for the next frame, into one request.
+     *
+     * @returns @c true if the memory is available, @c false if the pool could not be grown
+     * @since 6.7
+     **/
+    bool reserve(int32_t byteCount);
+    /**
+     * @returns the Buffer formats supported by the Wayland server
+     *
+     * The server announces the supported formats after the wl_shm got bound, thus
+     * they are only known after a roundtrip. Buffer::Format::ARGB32 and Buffer::Format::RGB32
+     * are always supported.
+     * @see supportsFormat
+     * @since 6.7
+     **/
+    QList<Buffer::Format> formats() const;
+    /**
+     * @returns whether the Wayland server supports Buffers with @p format
+     * @see formats
+     * @since 6.7
+     **/
+    bool supportsFormat(Buffer::Format format) const;
     wl_shm *shm();
 Q_SIGNALS:
     /**
-     * This signal is emitted whenever the shared memory pool gets resized.
+     * This signal is emitted whenever the shared memory pool gets mapped to a new address.
      * Any used Buffer must be remapped.
+     *
+     * Growing the pool within its reserved address range does not emit this signal.
      **/
     void poolResized();
 
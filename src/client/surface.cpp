@@ -21,6 +21,7 @@ namespace Client
 {
 
 QList<Surface *> Surface::Private::s_surfaces = QList<Surface *>();
+QHash<wl_surface *, Surface *> Surface::Private::s_nativeSurfaces;
 
 Surface::Private::Private(Surface *q)
     : q(q)
@@ -36,18 +37,20 @@ Surface::Surface(QObject *parent)
 
 Surface::~Surface()
 {
-    Private::s_surfaces.removeAll(this);
+    Private::s_surfaces.removeOne(this);
     release();
 }
 
 
 void Surface::release()
 {
+    Private::s_nativeSurfaces.remove(d->surface);
     d->surface.release();
 }
 
 void Surface::destroy()
 {
+    Private::s_nativeSurfaces.remove(d->surface);
     d->surface.destroy();
 }
 
@@ -61,6 +64,7 @@ void Surface::Private::setup(wl_surface *s)
     Q_ASSERT(s);
     Q_ASSERT(!surface);
     surface.setup(s);
+    s_nativeSurfaces.insert(s, q);
     wl_surface_add_listener(s, &s_surfaceListener, this);
 }
 
@@ -211,13 +215,10 @@ void Surface::setSize(const QSize &size)
 
 Surface *Surface::get(wl_surface *native)
 {
-    auto it = std::find_if(Private::s_surfaces.constBegin(), Private::s_surfaces.constEnd(), [native](Surface *s) {
-        return s->d->surface == native;
-    });
-    if (it != Private::s_surfaces.constEnd()) {
-        return *(it);
+    if (!native) {
+        return nullptr;
     }
-    return nullptr;
+    return Private::s_nativeSurfaces.value(native);
 }
 
 const QList<Surface *> &Surface::all()
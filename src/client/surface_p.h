@@ -8,6 +8,8 @@
 
 #include "surface.h"
 #include "wayland_pointer_p.h"
+// Qt
+#include <QHash>
 // Wayland
 #include <wayland-client-protocol.h>
 
@@ -31,6 +33,8 @@ public:
     void setup(wl_surface *s);
 
     static QList<Surface *> s_surfaces;
+    // the Surfaces by their wl_surface for constant time lookups in Surface::get
+    static QHash<wl_surface *, Surface *> s_nativeSurfaces;
 
 private:
     void handleFrameCallback();
@@ -0,0 +1,272 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "swapchain.h"
+#include "shm_pool.h"
+#include "surface.h"
+// Qt
+#include <QList>
+#include <QPointer>
+#include <QRegion>
+// STL
+#include <algorithm>
+
+namespace KWayland
+{
+namespace Client
+{
+namespace
+{
+// number of frames for which the damage is remembered
+constexpr int s_damageHistorySize = 4;
+}
+
+class Q_DECL_HIDDEN Swapchain::Private
+{
+public:
+    struct Slot {
+        Buffer::Ptr buffer;
+        // whether the Buffer got attached and was not yet released by the server
+        bool attached = false;
+        // the frame the Buffer holds, 0 if undefined
+        quint64 frame = 0;
+    };
+
+    Private(Surface *surface, ShmPool *pool);
+    void releaseSlot(Slot &slot);
+    void releaseSlots();
+    bool isAvailable(const Slot &slot) const;
+
+    QPointer<Surface> surface;
+    QPointer<ShmPool> pool;
+    QSize size;
+    Buffer::Format format = Buffer::Format::ARGB32;
+    int bufferCount = 2;
+    QList<Slot> bufferSlots;
+    // index of the acquired slot, -1 if none
+    int current = -1;
+    // number of presented frames
+    quint64 frame = 0;
+    // damage of the last presented frames, newest last
+    QList<QRegion> damageHistory;
+    bool framePending = false;
+};
+
+Swapchain::Private::Private(Surface *surface, ShmPool *pool)
+    : surface(surface)
+    , pool(pool)
+{
+}
+
+void Swapchain::Private::releaseSlot(Slot &slot)
+{
+    // hand the Buffer back to the ShmPool
+    if (auto buffer = slot.buffer.toStrongRef()) {
+        buffer->setUsed(false);
+    }
+    slot = Slot();
+}
+
+void Swapchain::Private::releaseSlots()
+{
+    for (Slot &slot : bufferSlots) {
+        releaseSlot(slot);
+    }
+    bufferSlots.clear();
+    current = -1;
+    damageHistory.clear();
+}
+
+bool Swapchain::Private::isAvailable(const Slot &slot) const
+{
+    auto buffer = slot.buffer.toStrongRef();
+    if (!buffer) {
+        return false;
+    }
+    return !slot.attached || buffer->isReleased();
+}
+
+Swapchain::Swapchain(Surface *surface, ShmPool *pool, QObject *parent)
+    : QObject(parent)
+    , d(new Private(surface, pool))
+{
+    connect(surface, &Surface::frameRendered, this, [this] {
+        if (!d->framePending) {
+            return;
+        }
+        d->framePending = false;
+        Q_EMIT frameReady();
+    });
+}
+
+Swapchain::~Swapchain()
+{
+    d->releaseSlots();
+}
+
+void Swapchain::setBufferCount(int count)
+{
+    count = std::max(count, 1);
+    if (d->bufferCount == count) {
+        return;
+    }
+    d->bufferCount = count;
+    while (d->bufferSlots.count() > count) {
+        const int index = d->bufferSlots.count() - 1;
+        if (index == d->current) {
+            // keep the acquired Buffer, drop another one instead
+            std::swap(d->bufferSlots[index], d->bufferSlots[index - 1]);
+            d->current = index - 1;
+        }
+        d->releaseSlot(d->bufferSlots.last());
+        d->bufferSlots.removeLast();
+    }
+}
+
+int Swapchain::bufferCount() const
+{
+    return d->bufferCount;
+}
+
+void Swapchain::setSize(const QSize &size, Buffer::Format format)
+{
+    if (d->size == size && d->format == format) {
+        return;
+    }
+    d->releaseSlots();
+    d->size = size;
+    d->format = format;
+}
+
+QSize Swapchain::size() const
+{
+    return d->size;
+}
+
+Buffer::Format Swapchain::format() const
+{
+    return d->format;
+}
+
+Buffer::Ptr Swapchain::acquire()
+{
+    if (d->current != -1) {
+        if (d->bufferSlots[d->current].buffer) {
+            return d->bufferSlots[d->current].buffer;
+        }
+        d->current = -1;
+    }
+    if (d->size.isEmpty() || !d->pool) {
+        return Buffer::Ptr();
+    }
+    // prefer the available Buffer holding the most recent frame
+    int candidate = -1;
+    for (int i = 0; i < d->bufferSlots.count(); ++i) {
+        const Private::Slot &slot = d->bufferSlots.at(i);
+        if (!slot.buffer) {
+            // destroyed by the ShmPool, e.g. after ShmPool::release
+            d->bufferSlots[i] = Private::Slot();
+            continue;
+        }
+        if (!d->isAvailable(slot)) {
+            continue;
+        }
+        if (candidate == -1 || slot.frame > d->bufferSlots.at(candidate).frame) {
+            candidate = i;
+        }
+    }
+    if (candidate == -1) {
+        // no Buffer available, create another one if allowed
+        int index = -1;
+        for (int i = 0; i < d->bufferSlots.count(); ++i) {
+            if (!d->bufferSlots.at(i).buffer) {
+                index = i;
+                break;
+            }
+        }
+        if (index == -1) {
+            if (d->bufferSlots.count() >= d->bufferCount) {
+                return Buffer::Ptr();
+            }
+            d->bufferSlots.append(Private::Slot());
+            index = d->bufferSlots.count() - 1;
+        }
+        Buffer::Ptr buffer = d->pool->getBuffer(d->size, d->size.width() * Buffer::bytesPerPixel(d->format), d->format);
+        auto strong = buffer.toStrongRef();
+        if (!strong) {
+            return Buffer::Ptr();
+        }
+        strong->setUsed(true);
+        d->bufferSlots[index].buffer = buffer;
+        candidate = index;
+    }
+    d->current = candidate;
+    return d->bufferSlots.at(candidate).buffer;
+}
+
+int Swapchain::bufferAge() const
+{
+    if (d->current == -1) {
+        return 0;
+    }
+    const quint64 frame = d->bufferSlots.at(d->current).frame;
+    if (frame == 0) {
+        return 0;
+    }
+    return int(d->frame - frame + 1);
+}
+
+QRegion Swapchain::bufferDamage() const
+{
+    const QRegion everything(QRect(QPoint(0, 0), d->size));
+    const int age = bufferAge();
+    if (age == 0 || age - 1 > d->damageHistory.count()) {
+        return everything;
+    }
+    QRegion damage;
+    for (int i = d->damageHistory.count() - (age - 1); i < d->damageHistory.count(); ++i) {
+        damage += d->damageHistory.at(i);
+    }
+    return damage.intersected(everything);
+}
+
+void Swapchain::present(const QRegion &damage)
+{
+    if (d->current == -1 || !d->surface) {
+        return;
+    }
+    Private::Slot &slot = d->bufferSlots[d->current];
+    auto buffer = slot.buffer.toStrongRef();
+    d->current = -1;
+    if (!buffer) {
+        return;
+    }
+    buffer->setReleased(false);
+    slot.attached = true;
+    slot.frame = ++d->frame;
+    d->damageHistory.append(damage);
+    if (d->damageHistory.count() > s_damageHistorySize) {
+        d->damageHistory.removeFirst();
+    }
+
+    d->surface->attachBuffer(buffer.data());
+    d->surface->damageBuffer(damage);
+    if (d->framePending) {
+        d->surface->commit(Surface::CommitFlag::None);
+    } else {
+        d->framePending = true;
+        d->surface->commit(Surface::CommitFlag::FrameCallback);
+    }
+}
+
+bool Swapchain::isFramePending() const
+{
+    return d->framePending;
+}
+
+}
+}
+
+#include "moc_swapchain.cpp"
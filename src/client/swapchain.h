@@ -0,0 +1,152 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#ifndef WAYLAND_SWAPCHAIN_H
+#define WAYLAND_SWAPCHAIN_H
+
+#include <QObject>
+
+#include "KWayland/Client/kwaylandclient_export.h"
+#include "buffer.h"
+
+class QRegion;
+
+namespace KWayland
+{
+namespace Client
+{
+class ShmPool;
+class Surface;
+
+/**
+ * @short A set of Buffers to render a Surface with.
+ *
+ * The Swapchain manages a fixed number of Buffers from a ShmPool to render consecutive frames
+ * of a Surface. Instead of requesting Buffers from the ShmPool and tracking whether the Wayland
+ * server still holds them, a client acquires the next Buffer from the Swapchain, renders into it
+ * and presents it:
+ *
+ * @code
+ * Swapchain *swapchain = new Swapchain(surface, shmPool);
+ * swapchain->setSize(QSize(200, 100), Buffer::Format::ARGB32);
+ *
+ * auto render = [swapchain] {
+ *     Buffer::Ptr buffer = swapchain->acquire();
+ *     if (!buffer) {
+ *         // all Buffers are still held by the server
+ *         return;
+ *     }
+ *     QImage image = buffer.toStrongRef()->image();
+ *     // repaint what changed since this Buffer was presented the last time
+ *     const QRegion repaint = swapchain->bufferDamage() + newDamage;
+ *     // ...
+ *     swapchain->present(newDamage);
+ * };
+ * connect(swapchain, &Swapchain::frameReady, swapchain, render);
+ * @endcode
+ *
+ * The Buffers are created lazily up to bufferCount and stay marked as used in the ShmPool for the
+ * life time of the Swapchain, thus they are not handed out to anybody else. Once all Buffers are
+ * created acquiring and presenting frames does not allocate any further Buffers. Whenever the
+ * Wayland server releases a Buffer it becomes available to acquire again.
+ *
+ * For partial repaints the Swapchain tracks the age of each Buffer: the number of frames
+ * since the content of the Buffer got presented. bufferDamage provides the area which changed
+ * since then.
+ *
+ * Presenting a frame requests a frame callback. While the frame callback is pending new frames
+ * should not be rendered, the signal frameReady is emitted once the server indicates that it
+ * is a good time to render the next frame.
+ *
+ * @see ShmPool
+ * @see Surface
+ * @since 6.7
+ **/
+class KWAYLANDCLIENT_EXPORT Swapchain : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * Creates a Swapchain presenting on @p surface with Buffers from @p pool.
+     **/
+    explicit Swapchain(Surface *surface, ShmPool *pool, QObject *parent = nullptr);
+    ~Swapchain() override;
+
+    /**
+     * Sets the maximum number of Buffers to @p count. The default is @c 2.
+     * Lowering the count releases the Buffers which are not needed anymore.
+     **/
+    void setBufferCount(int count);
+    /**
+     * @returns the maximum number of Buffers
+     **/
+    int bufferCount() const;
+
+    /**
+     * Sets the @p size and the @p format of the Buffers.
+     * If they change all Buffers are released and new Buffers are created on demand.
+     **/
+    void setSize(const QSize &size, Buffer::Format format = Buffer::Format::ARGB32);
+    /**
+     * @returns the size of the Buffers
+     **/
+    QSize size() const;
+    /**
+     * @returns the format of the Buffers
+     **/
+    Buffer::Format format() const;
+
+    /**
+     * Provides the Buffer to render the next frame into. The Buffer stays the current Buffer
+     * until it gets presented.
+     *
+     * @returns The Buffer to render into or a @c null Buffer::Ptr if all Buffers are held by the server
+     * @see present
+     **/
+    Buffer::Ptr acquire();
+    /**
+     * @returns the age of the currently acquired Buffer: @c 1 if it holds the content of
+     * the previous frame, @c 2 if it holds the content of the frame before and so on, @c 0 if
+     * the content is undefined.
+     **/
+    int bufferAge() const;
+    /**
+     * @returns the area which changed since the frame the currently acquired Buffer holds.
+     * If the content of the Buffer is undefined or older than the remembered frames the
+     * complete area of the Buffer is returned.
+     **/
+    QRegion bufferDamage() const;
+
+    /**
+     * Attaches the currently acquired Buffer to the Surface, marks @p damage as damaged and
+     * commits the Surface. Unless a frame callback is still pending a new frame callback
+     * is requested.
+     *
+     * @param damage The area in buffer coordinates which changed compared to the previous frame
+     * @see frameReady
+     **/
+    void present(const QRegion &damage);
+    /**
+     * @returns @c true if a presented frame waits for its frame callback
+     * @see frameReady
+     **/
+    bool isFramePending() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted when the frame callback for a presented frame arrived and a
+     * new frame may be rendered.
+     **/
+    void frameReady();
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+}
+}
+
+#endif
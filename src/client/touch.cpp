@@ -12,6 +12,8 @@
 #include <QPointer>
 // wayland
 #include <wayland-client-protocol.h>
+// STL
+#include <utility>
 
 namespace KWayland
 {
@@ -27,6 +29,22 @@ public:
     QList<TouchPoint *> sequence;
     TouchPoint *getActivePoint(qint32 id) const;
 
+    // emits pointMoved for the points moved in the coalesced frames followed by frameEnded
+    void flushFrames();
+    // like flushFrames, followed by pointMoved for the points moved in the frame in progress
+    void flush();
+    void scheduleFlush();
+    bool coalescing = false;
+    bool flushScheduled = false;
+    bool framePending = false;
+    // moved in the ended frames
+    QList<TouchPoint *> movedPoints;
+    // moved in the frame in progress
+    QList<TouchPoint *> currentMovedPoints;
+    void frameEnded();
+    HistoryPolicy historyPolicy = HistoryPolicy::KeepAll;
+    int historySize = 0;
+
 private:
     static void downCallback(void *data, wl_touch *touch, uint32_t serial, uint32_t time, wl_surface *surface, int32_t id, wl_fixed_t x, wl_fixed_t y);
     static void upCallback(void *data, wl_touch *touch, uint32_t serial, uint32_t time, int32_t id);
@@ -44,15 +62,43 @@ private:
 class TouchPoint::Private
 {
 public:
+    void addSample(const QPointF &position, quint32 time);
+    Sample sample(int index) const;
+
     qint32 id = 0;
     quint32 downSerial = 0;
     quint32 upSerial = 0;
     QPointer<Surface> surface;
-    QList<QPointF> positions;
-    QList<quint32> timestamps;
+    // 0 if all samples are kept, otherwise samples is used as a ring buffer of this size
+    int capacity = 0;
+    QList<Sample> samples;
+    // index of the oldest sample in the ring buffer
+    int head = 0;
+    Sample latest = {QPointF(), 0};
+    quint64 sampleTotal = 0;
+    // value of sampleTotal at the last frame
+    quint64 frameMark = 0;
+    quint32 upTime = 0;
     bool down = true;
 };
 
+void TouchPoint::Private::addSample(const QPointF &position, quint32 time)
+{
+    latest = {position, time};
+    ++sampleTotal;
+    if (capacity == 0 || samples.count() < capacity) {
+        samples.append(latest);
+        return;
+    }
+    samples[head] = latest;
+    head = (head + 1) % capacity;
+}
+
+TouchPoint::Sample TouchPoint::Private::sample(int index) const
+{
+    return samples.at((head + index) % samples.count());
+}
+
 TouchPoint::TouchPoint()
     : d(new Private)
 {
@@ -62,15 +108,41 @@ TouchPoint::~TouchPoint() = default;
 
 QPointF TouchPoint::position() const
 {
-    if (d->positions.isEmpty()) {
-        return QPointF();
-    }
-    return d->positions.last();
+    return d->latest.position;
 }
 
 QList<QPointF> TouchPoint::positions() const
 {
-    return d->positions;
+    QList<QPointF> positions;
+    positions.reserve(d->samples.count());
+    for (int i = 0; i < d->samples.count(); ++i) {
+        positions << d->sample(i).position;
+    }
+    return positions;
+}
+
+int TouchPoint::sampleCount() const
+{
+    return d->samples.count();
+}
+
+TouchPoint::Sample TouchPoint::sample(int index) const
+{
+    Q_ASSERT(index >= 0 && index < d->samples.count());
+    return d->sample(index);
+}
+
+QList<TouchPoint::Sample> TouchPoint::samples() const
+{
+    if (d->head == 0) {
+        return d->samples;
+    }
+    return d->samples.mid(d->head) + d->samples.first(d->head);
+}
+
+int TouchPoint::newSampleCount() const
+{
+    return int(qMin<quint64>(d->sampleTotal - d->frameMark, d->samples.count()));
 }
 
 quint32 TouchPoint::downSerial() const
@@ -90,15 +162,23 @@ QPointer<Surface> TouchPoint::surface() const
 
 quint32 TouchPoint::time() const
 {
-    if (d->timestamps.isEmpty()) {
-        return 0;
+    if (!d->down) {
+        return d->upTime;
     }
-    return d->timestamps.last();
+    return d->latest.time;
 }
 
 QList<quint32> TouchPoint::timestamps() const
 {
-    return d->timestamps;
+    QList<quint32> timestamps;
+    timestamps.reserve(d->samples.count() + 1);
+    for (int i = 0; i < d->samples.count(); ++i) {
+        timestamps << d->sample(i).time;
+    }
+    if (!d->down) {
+        timestamps << d->upTime;
+    }
+    return timestamps;
 }
 
 bool TouchPoint::isDown() const
@@ -126,6 +206,52 @@ void Touch::Private::setup(wl_touch *t)
 
 const wl_touch_listener Touch::Private::s_listener = {downCallback, upCallback, motionCallback, frameCallback, cancelCallback};
 
+void Touch::Private::flushFrames()
+{
+    const QList<TouchPoint *> moved = std::exchange(movedPoints, {});
+    for (TouchPoint *p : moved) {
+        Q_EMIT q->pointMoved(p);
+    }
+    if (std::exchange(framePending, false)) {
+        frameEnded();
+    }
+}
+
+void Touch::Private::flush()
+{
+    // the ended frames come before the motion of the frame in progress
+    flushFrames();
+    const QList<TouchPoint *> moved = std::exchange(currentMovedPoints, {});
+    for (TouchPoint *p : moved) {
+        Q_EMIT q->pointMoved(p);
+    }
+}
+
+void Touch::Private::scheduleFlush()
+{
+    if (flushScheduled) {
+        return;
+    }
+    flushScheduled = true;
+    // flush once all events read together got dispatched
+    QMetaObject::invokeMethod(
+        q,
+        [this] {
+            flushScheduled = false;
+            // a frame in progress is completed by the events still to be read
+            flushFrames();
+        },
+        Qt::QueuedConnection);
+}
+
+void Touch::Private::frameEnded()
+{
+    Q_EMIT q->frameEnded();
+    for (TouchPoint *p : std::as_const(sequence)) {
+        p->d->frameMark = p->d->sampleTotal;
+    }
+}
+
 void Touch::Private::downCallback(void *data, wl_touch *touch, uint32_t serial, uint32_t time, wl_surface *surface, int32_t id, wl_fixed_t x, wl_fixed_t y)
 {
     auto t = reinterpret_cast<Touch::Private *>(data);
@@ -135,12 +261,24 @@ void Touch::Private::downCallback(void *data, wl_touch *touch, uint32_t serial,
 
 void Touch::Private::down(quint32 serial, quint32 time, qint32 id, const QPointF &position, const QPointer<Surface> &surface)
 {
+    // a new sequence deletes the moved points
+    flush();
     TouchPoint *p = new TouchPoint;
     p->d->downSerial = serial;
     p->d->surface = surface;
     p->d->id = id;
-    p->d->positions << position;
-    p->d->timestamps << time;
+    switch (historyPolicy) {
+    case HistoryPolicy::KeepAll:
+        break;
+    case HistoryPolicy::KeepLast:
+        p->d->capacity = qMax(historySize, 1);
+        p->d->samples.reserve(p->d->capacity);
+        break;
+    case HistoryPolicy::KeepNone:
+        p->d->capacity = 1;
+        break;
+    }
+    p->d->addSample(position, time);
     if (active) {
         sequence << p;
         Q_EMIT q->pointAdded(p);
@@ -177,7 +315,8 @@ void Touch::Private::up(quint32 serial, quint32 time, qint32 id)
     if (!p) {
         return;
     }
-    p->d->timestamps << time;
+    flush();
+    p->d->upTime = time;
     p->d->upSerial = serial;
     p->d->down = false;
     Q_EMIT q->pointRemoved(p);
@@ -205,8 +344,13 @@ void Touch::Private::motion(quint32 time, qint32 id, const QPointF &position)
     if (!p) {
         return;
     }
-    p->d->positions << position;
-    p->d->timestamps << time;
+    p->d->addSample(position, time);
+    if (coalescing) {
+        if (!currentMovedPoints.contains(p)) {
+            currentMovedPoints << p;
+        }
+        return;
+    }
     Q_EMIT q->pointMoved(p);
 }
 
@@ -214,13 +358,26 @@ void Touch::Private::frameCallback(void *data, wl_touch *touch)
 {
     auto t = reinterpret_cast<Touch::Private *>(data);
     Q_ASSERT(t->touch == touch);
-    Q_EMIT t->q->frameEnded();
+    if (!t->coalescing) {
+        t->frameEnded();
+        return;
+    }
+    // merge the ended frame into the previous ones
+    const QList<TouchPoint *> moved = std::exchange(t->currentMovedPoints, {});
+    for (TouchPoint *p : moved) {
+        if (!t->movedPoints.contains(p)) {
+            t->movedPoints << p;
+        }
+    }
+    t->framePending = true;
+    t->scheduleFlush();
 }
 
 void Touch::Private::cancelCallback(void *data, wl_touch *touch)
 {
     auto t = reinterpret_cast<Touch::Private *>(data);
     Q_ASSERT(t->touch == touch);
+    t->flush();
     t->active = false;
     Q_EMIT t->q->sequenceCanceled();
 }
@@ -266,6 +423,38 @@ Touch::operator wl_touch *()
     return d->touch;
 }
 
+void Touch::setEventCoalescing(bool enable)
+{
+    if (d->coalescing == enable) {
+        return;
+    }
+    if (!enable) {
+        d->flush();
+    }
+    d->coalescing = enable;
+}
+
+bool Touch::isEventCoalescing() const
+{
+    return d->coalescing;
+}
+
+void Touch::setHistoryPolicy(HistoryPolicy policy, int size)
+{
+    d->historyPolicy = policy;
+    d->historySize = size;
+}
+
+Touch::HistoryPolicy Touch::historyPolicy() const
+{
+    return d->historyPolicy;
+}
+
+int Touch::historySize() const
+{
+    return d->historySize;
+}
+
 QList<TouchPoint *> Touch::sequence() const
 {
     return d->sequence;
@@ -28,6 +28,22 @@ class KWAYLANDCLIENT_EXPORT TouchPoint
 public:
     virtual ~TouchPoint();
 
+    /**
+     * One position of the TouchPoint together with the timestamp it got reported.
+     * @see sample
+     * @since 6.7
+     **/
+    struct Sample {
+        /**
+         * The position relative to the Surface.
+         **/
+        QPointF position;
+        /**
+         * Timestamp with millisecond granularity.
+         **/
+        quint32 time;
+    };
+
     /**
      * Unique in the scope of all TouchPoints currently being down.
      * As soon as the TouchPoint is now longer down another TouchPoint
@@ -47,8 +63,10 @@ public:
      **/
     quint32 time() const;
     /**
-     * All timestamps, references the positions.
-     * That is each position has a timestamp.
+     * All recorded timestamps, references the positions.
+     * That is each position has a timestamp. Once the TouchPoint is
+     * up the timestamp of the up event is appended.
+     * @see Touch::HistoryPolicy
      **/
     QList<quint32> timestamps() const;
     /**
@@ -56,9 +74,39 @@ public:
      **/
     QPointF position() const;
     /**
-     * All positions this TouchPoint had, updated with each move.
+     * All recorded positions this TouchPoint had, updated with each move.
+     * @see Touch::HistoryPolicy
      **/
     QList<QPointF> positions() const;
+
+    /**
+     * @returns the number of recorded samples
+     * @see Touch::HistoryPolicy
+     * @since 6.7
+     **/
+    int sampleCount() const;
+    /**
+     * @returns the recorded sample at @p index, the oldest sample has index @c 0
+     * @since 6.7
+     **/
+    Sample sample(int index) const;
+    /**
+     * All recorded samples, oldest first.
+     * @since 6.7
+     **/
+    QList<Sample> samples() const;
+    /**
+     * @returns the number of samples added since the last Touch::frameEnded. Those are the
+     * last samples, thus they can be iterated without copying the history:
+     * @code
+     * for (int i = point->sampleCount() - point->newSampleCount(); i < point->sampleCount(); ++i) {
+     *     draw(point->sample(i));
+     * }
+     * @endcode
+     * If more samples got added than the history holds, only the recorded samples are counted.
+     * @since 6.7
+     **/
+    int newSampleCount() const;
     /**
      * The Surface this TouchPoint happened on.
      **/
@@ -88,6 +136,25 @@ class KWAYLANDCLIENT_EXPORT Touch : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * Describes how many positions a TouchPoint records.
+     * @see setHistoryPolicy
+     * @since 6.7
+     **/
+    enum class HistoryPolicy {
+        /**
+         * All positions are recorded.
+         **/
+        KeepAll,
+        /**
+         * The most recent positions are recorded in a buffer of fixed size.
+         **/
+        KeepLast,
+        /**
+         * Only the current position is recorded.
+         **/
+        KeepNone,
+    };
     explicit Touch(QObject *parent = nullptr);
     ~Touch() override;
 
@@ -132,6 +199,51 @@ public:
      **/
     QList<TouchPoint *> sequence() const;
 
+    /**
+     * Enables or disables coalescing of motion events.
+     *
+     * With coalescing enabled pointMoved is not emitted for each motion event, but once per
+     * moved TouchPoint at the end of a frame. All frames dispatched together are merged and
+     * followed by a single frameEnded signal. The positions of all motion events are still
+     * recorded in the TouchPoint.
+     *
+     * Pending pointMoved signals are emitted before any other signal, so the order of
+     * events is preserved. By default coalescing is disabled.
+     *
+     * @see TouchPoint::positions
+     * @since 6.7
+     **/
+    void setEventCoalescing(bool enable);
+    /**
+     * @returns whether motion events are coalesced
+     * @see setEventCoalescing
+     * @since 6.7
+     **/
+    bool isEventCoalescing() const;
+
+    /**
+     * Sets the @p policy for recording the positions of TouchPoints. With HistoryPolicy::KeepLast
+     * the last @p size positions are recorded in a buffer which is allocated once per TouchPoint,
+     * thus the memory usage is bounded even for very long strokes.
+     *
+     * The policy applies to TouchPoints added afterwards. The default is HistoryPolicy::KeepAll.
+     *
+     * @see TouchPoint::positions
+     * @see TouchPoint::sample
+     * @since 6.7
+     **/
+    void setHistoryPolicy(HistoryPolicy policy, int size = 0);
+    /**
+     * @returns how positions of TouchPoints are recorded
+     * @since 6.7
+     **/
+    HistoryPolicy historyPolicy() const;
+    /**
+     * @returns the number of positions recorded with HistoryPolicy::KeepLast
+     * @since 6.7
+     **/
+    int historySize() const;
+
     operator wl_touch *();
     operator wl_touch *() const;
 
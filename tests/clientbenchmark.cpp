@@ -0,0 +1,201 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "mockcompositor.h"
+// KWayland
+#include "../src/client/bootstrap.h"
+#include "../src/client/compositor.h"
+#include "../src/client/connection_thread.h"
+#include "../src/client/event_queue.h"
+#include "../src/client/plasmawindowmanagement.h"
+#include "../src/client/pointer.h"
+#include "../src/client/registry.h"
+#include "../src/client/seat.h"
+#include "../src/client/shm_pool.h"
+#include "../src/client/surface.h"
+// Qt
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+// wayland
+#include <wayland-client-core.h>
+
+using namespace KWayland::Client;
+using KWayland::Test::MockCompositor;
+
+class ClientBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkBootstrap();
+    void benchmarkShmPoolChurn();
+    void benchmarkPlasmaWindowManagement_data();
+    void benchmarkPlasmaWindowManagement();
+    void benchmarkPointerMotionFlood_data();
+    void benchmarkPointerMotionFlood();
+
+private:
+    // a client connection to the MockCompositor, torn down on destruction
+    struct Connection {
+        Connection(MockCompositor *compositor, const QList<Registry::Interface> &interfaces);
+        ~Connection();
+        QThread *thread;
+        ConnectionThread *connection;
+        Bootstrap *bootstrap = nullptr;
+    };
+
+    MockCompositor *m_compositor = nullptr;
+};
+
+ClientBenchmark::Connection::Connection(MockCompositor *compositor, const QList<Registry::Interface> &interfaces)
+    : thread(new QThread)
+    , connection(new ConnectionThread)
+{
+    QSignalSpy connectedSpy(connection, &ConnectionThread::connected);
+    connection->setSocketFd(compositor->createClientFd());
+    connection->moveToThread(thread);
+    thread->start();
+    connection->initConnection();
+    if (!connectedSpy.wait()) {
+        return;
+    }
+    bootstrap = new Bootstrap(connection);
+    bootstrap->setInterfaces(interfaces);
+    QSignalSpy readySpy(bootstrap, &Bootstrap::ready);
+    bootstrap->start();
+    readySpy.wait();
+}
+
+ClientBenchmark::Connection::~Connection()
+{
+    delete bootstrap;
+    connection->deleteLater();
+    thread->quit();
+    thread->wait();
+    delete thread;
+}
+
+void ClientBenchmark::initTestCase()
+{
+    m_compositor = new MockCompositor;
+}
+
+void ClientBenchmark::cleanupTestCase()
+{
+    delete m_compositor;
+    m_compositor = nullptr;
+}
+
+void ClientBenchmark::benchmarkBootstrap()
+{
+    QBENCHMARK {
+        Connection c(m_compositor,
+                     {Registry::Interface::Compositor,
+                      Registry::Interface::Shm,
+                      Registry::Interface::Seat,
+                      Registry::Interface::Output,
+                      Registry::Interface::XdgOutputUnstableV1});
+        QVERIFY(c.bootstrap);
+        QVERIFY(c.bootstrap->isReady());
+        QCOMPARE(c.bootstrap->outputs().count(), 1);
+        QVERIFY(c.bootstrap->xdgOutput(c.bootstrap->outputs().first()));
+        QCOMPARE(c.bootstrap->seats().count(), 1);
+    }
+}
+
+void ClientBenchmark::benchmarkShmPoolChurn()
+{
+    Connection c(m_compositor, {Registry::Interface::Shm});
+    QVERIFY(c.bootstrap);
+    ShmPool *pool = c.bootstrap->shmPool();
+    QVERIFY(pool);
+
+    // the compositor holds a few attached Buffers before releasing them again
+    static const int s_buffersInFlight = 3;
+    QList<Buffer::Ptr> inFlight;
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            const QSize size(64 + (i % 8) * 32, 64 + (i % 3) * 32);
+            auto buffer = pool->getBuffer(size, size.width() * 4, Buffer::Format::ARGB32);
+            auto strongBuffer = buffer.toStrongRef();
+            QVERIFY(strongBuffer);
+            strongBuffer->setUsed(true);
+            strongBuffer->setUsed(false);
+            inFlight << buffer;
+            if (inFlight.count() > s_buffersInFlight) {
+                // what the wl_buffer.release event of the compositor does
+                if (auto released = inFlight.takeFirst().toStrongRef()) {
+                    released->setReleased(true);
+                }
+            }
+        }
+    }
+    for (const auto &buffer : std::as_const(inFlight)) {
+        if (auto released = buffer.toStrongRef()) {
+            released->setReleased(true);
+        }
+    }
+}
+
+void ClientBenchmark::benchmarkPlasmaWindowManagement_data()
+{
+    QTest::addColumn<int>("windows");
+
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("5000") << 5000;
+}
+
+void ClientBenchmark::benchmarkPlasmaWindowManagement()
+{
+    QFETCH(int, windows);
+    m_compositor->addWindows(windows - m_compositor->windowCount());
+
+    QBENCHMARK {
+        Connection c(m_compositor, {Registry::Interface::PlasmaWindowManagement});
+        QVERIFY(c.bootstrap);
+        auto management = c.bootstrap->registry()->lazyManager(Registry::Interface::PlasmaWindowManagement, &Registry::createPlasmaWindowManagement);
+        QVERIFY(management);
+        QSignalSpy spy(management, &PlasmaWindowManagement::windowCreated);
+        QTRY_COMPARE_WITH_TIMEOUT(spy.count(), windows, 60000);
+    }
+}
+
+void ClientBenchmark::benchmarkPointerMotionFlood_data()
+{
+    QTest::addColumn<int>("events");
+
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void ClientBenchmark::benchmarkPointerMotionFlood()
+{
+    QFETCH(int, events);
+    Connection c(m_compositor, {Registry::Interface::Compositor, Registry::Interface::Seat});
+    QVERIFY(c.bootstrap);
+    QVERIFY(c.bootstrap->compositor());
+    QCOMPARE(c.bootstrap->seats().count(), 1);
+    Seat *seat = c.bootstrap->seats().first();
+    QVERIFY(seat->hasPointer());
+    Pointer *pointer = seat->createPointer(seat);
+    Surface *surface = c.bootstrap->compositor()->createSurface(c.bootstrap);
+    QVERIFY(surface);
+    // ensure the MockCompositor knows about the pointer and the surface, the default queue is
+    // dispatched by the ConnectionThread, thus roundtrip on the queue of this thread
+    QVERIFY(wl_display_roundtrip_queue(c.connection->display(), *c.bootstrap->eventQueue()) >= 0);
+
+    QBENCHMARK {
+        QSignalSpy motionSpy(pointer, &Pointer::motion);
+        m_compositor->sendPointerMotion(events);
+        QTRY_COMPARE_WITH_TIMEOUT(motionSpy.count(), events, 60000);
+    }
+}
+
+QTEST_GUILESS_MAIN(ClientBenchmark)
+#include "clientbenchmark.moc"
@@ -8,6 +8,7 @@
 #include "../src/client/datadevice.h"
 #include "../src/client/datadevicemanager.h"
 #include "../src/client/datasource.h"
+#include "../src/client/datatransfer.h"
 #include "../src/client/event_queue.h"
 #include "../src/client/keyboard.h"
 #include "../src/client/pointer.h"
@@ -19,7 +20,6 @@
 // Qt
 #include <QCoreApplication>
 #include <QDebug>
-#include <QFile>
 #include <QImage>
 #include <QThread>
 
@@ -151,12 +151,13 @@ void CopyClient::render()
 void CopyClient::copy(const QString &mimeType, qint32 fd)
 {
     qDebug() << "Requested to copy for mimeType" << mimeType;
-    QFile c;
-    if (c.open(fd, QFile::WriteOnly, QFile::AutoCloseHandle)) {
-        c.write(QByteArrayLiteral("foo"));
-        c.close();
-        qDebug() << "Copied foo";
-    }
+    auto transfer = m_copySource->sendData(fd, QByteArrayLiteral("foo"));
+    connect(transfer, &DataTransfer::finished, transfer, [transfer] {
+        if (transfer->state() == DataTransfer::State::Finished) {
+            qDebug() << "Copied foo";
+        }
+        transfer->deleteLater();
+    });
 }
 
 int main(int argc, char **argv)
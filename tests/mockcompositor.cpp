@@ -0,0 +1,470 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "mockcompositor.h"
+// Qt
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QUuid>
+// system
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+// wayland
+#include <wayland-plasma-window-management-server-protocol.h>
+#include <wayland-server.h>
+#include <wayland-xdg-output-unstable-v1-server-protocol.h>
+#include <wayland-xdg-shell-server-protocol.h>
+// STL
+#include <algorithm>
+#include <atomic>
+
+namespace KWayland
+{
+namespace Test
+{
+namespace
+{
+// handles one request, the arguments are as described by the signature of the request
+using Handler = std::function<void(wl_resource *resource, const char *request, wl_argument *args)>;
+
+// closes all file descriptors passed with a request, the MockCompositor does not use any
+void closeFds(const wl_message *message, wl_argument *args)
+{
+    int i = 0;
+    for (const char *signature = message->signature; *signature; ++signature) {
+        if (*signature == '?' || (*signature >= '0' && *signature <= '9')) {
+            continue;
+        }
+        if (*signature == 'h') {
+            close(args[i].h);
+        }
+        ++i;
+    }
+}
+
+int dispatch(const void *implementation, void *target, uint32_t opcode, const wl_message *message, wl_argument *args)
+{
+    Q_UNUSED(opcode)
+    auto resource = reinterpret_cast<wl_resource *>(target);
+    if (qstrcmp(message->name, "destroy") == 0 || qstrcmp(message->name, "release") == 0) {
+        wl_resource_destroy(resource);
+        return 0;
+    }
+    auto handler = reinterpret_cast<const Handler *>(implementation);
+    if (handler && *handler) {
+        (*handler)(resource, message->name, args);
+    }
+    closeFds(message, args);
+    return 0;
+}
+}
+
+class MockCompositor::Private
+{
+public:
+    struct Window {
+        quint32 id;
+        QByteArray uuid;
+        QByteArray title;
+    };
+
+    Private();
+    ~Private();
+    void post(const std::function<void()> &function);
+    wl_resource *createResource(wl_client *client, const wl_interface *interface, int version, uint32_t id, const Handler *handler);
+    void createGlobals();
+    void announceWindow(wl_resource *management, const Window &window);
+    void createWindow(wl_client *client, wl_resource *management, uint32_t id, const Window *window);
+
+    static void wakeUp(int fd, uint32_t mask, void *data);
+    static void resourceDestroyed(wl_resource *resource);
+
+    wl_display *display = nullptr;
+    int wakeFd = -1;
+    QThread *thread = nullptr;
+    QMutex mutex;
+    QList<std::function<void()>> pending;
+
+    // only accessed from the compositor thread
+    QList<Window> windows;
+    // indices into windows by id and by uuid
+    QHash<quint32, qsizetype> windowsById;
+    QHash<QByteArray, qsizetype> windowsByUuid;
+    quint32 nextWindowId = 1;
+    QList<wl_resource *> windowManagements;
+    QList<wl_resource *> pointers;
+    QList<wl_resource *> surfaces;
+    std::atomic<int> windowCount = 0;
+
+    Handler noopHandler;
+    Handler compositorHandler;
+    Handler surfaceHandler;
+    Handler seatHandler;
+    Handler xdgWmBaseHandler;
+    Handler xdgSurfaceHandler;
+    Handler xdgOutputManagerHandler;
+    Handler subCompositorHandler;
+    Handler dataDeviceManagerHandler;
+    Handler windowManagementHandler;
+};
+
+MockCompositor::Private::Private()
+{
+    display = wl_display_create();
+    // event floods must not disconnect a client which is slow to read
+    wl_display_set_default_max_buffer_size(display, 0);
+    wl_display_init_shm(display);
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    wl_event_loop_add_fd(wl_display_get_event_loop(display), wakeFd, WL_EVENT_READABLE, wakeUp, this);
+    createGlobals();
+    thread = QThread::create([this] {
+        wl_display_run(display);
+    });
+    thread->start();
+}
+
+MockCompositor::Private::~Private()
+{
+    post([this] {
+        wl_display_terminate(display);
+    });
+    thread->wait();
+    delete thread;
+    wl_display_destroy_clients(display);
+    wl_display_destroy(display);
+    close(wakeFd);
+}
+
+void MockCompositor::Private::post(const std::function<void()> &function)
+{
+    {
+        QMutexLocker locker(&mutex);
+        pending << function;
+    }
+    const uint64_t value = 1;
+    Q_UNUSED(write(wakeFd, &value, sizeof(value)))
+}
+
+void MockCompositor::Private::wakeUp(int fd, uint32_t mask, void *data)
+{
+    Q_UNUSED(mask)
+    auto d = reinterpret_cast<MockCompositor::Private *>(data);
+    uint64_t value;
+    Q_UNUSED(read(fd, &value, sizeof(value)))
+    QList<std::function<void()>> functions;
+    {
+        QMutexLocker locker(&d->mutex);
+        functions.swap(d->pending);
+    }
+    for (const auto &function : std::as_const(functions)) {
+        function();
+    }
+    wl_display_flush_clients(d->display);
+}
+
+void MockCompositor::Private::resourceDestroyed(wl_resource *resource)
+{
+    auto d = reinterpret_cast<MockCompositor::Private *>(wl_resource_get_user_data(resource));
+    d->windowManagements.removeOne(resource);
+    d->pointers.removeOne(resource);
+    d->surfaces.removeOne(resource);
+}
+
+wl_resource *MockCompositor::Private::createResource(wl_client *client, const wl_interface *interface, int version, uint32_t id, const Handler *handler)
+{
+    wl_resource *resource = wl_resource_create(client, interface, version, id);
+    if (!resource) {
+        wl_client_post_no_memory(client);
+        return nullptr;
+    }
+    wl_resource_set_dispatcher(resource, dispatch, handler, this, resourceDestroyed);
+    return resource;
+}
+
+void MockCompositor::Private::createGlobals()
+{
+    compositorHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        wl_client *client = wl_resource_get_client(resource);
+        if (qstrcmp(request, "create_surface") == 0) {
+            if (wl_resource *surface = createResource(client, &wl_surface_interface, wl_resource_get_version(resource), args[0].n, &surfaceHandler)) {
+                surfaces << surface;
+            }
+        } else if (qstrcmp(request, "create_region") == 0) {
+            createResource(client, &wl_region_interface, 1, args[0].n, &noopHandler);
+        }
+    };
+    surfaceHandler = [](wl_resource *resource, const char *request, wl_argument *args) {
+        if (qstrcmp(request, "frame") == 0) {
+            // there is no rendering, every frame is presented immediately
+            wl_resource *callback = wl_resource_create(wl_resource_get_client(resource), &wl_callback_interface, 1, args[0].n);
+            if (callback) {
+                wl_callback_send_done(callback, 0);
+                wl_resource_destroy(callback);
+            }
+        }
+    };
+    seatHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        wl_client *client = wl_resource_get_client(resource);
+        const int version = wl_resource_get_version(resource);
+        if (qstrcmp(request, "get_pointer") == 0) {
+            if (wl_resource *pointer = createResource(client, &wl_pointer_interface, version, args[0].n, &noopHandler)) {
+                pointers << pointer;
+            }
+        } else if (qstrcmp(request, "get_keyboard") == 0) {
+            createResource(client, &wl_keyboard_interface, version, args[0].n, &noopHandler);
+        } else if (qstrcmp(request, "get_touch") == 0) {
+            createResource(client, &wl_touch_interface, version, args[0].n, &noopHandler);
+        }
+    };
+    xdgWmBaseHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        wl_client *client = wl_resource_get_client(resource);
+        const int version = wl_resource_get_version(resource);
+        if (qstrcmp(request, "create_positioner") == 0) {
+            createResource(client, &xdg_positioner_interface, version, args[0].n, &noopHandler);
+        } else if (qstrcmp(request, "get_xdg_surface") == 0) {
+            createResource(client, &xdg_surface_interface, version, args[0].n, &xdgSurfaceHandler);
+        }
+    };
+    xdgSurfaceHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        wl_client *client = wl_resource_get_client(resource);
+        const int version = wl_resource_get_version(resource);
+        // the role is configured right away, the client picks its own size
+        if (qstrcmp(request, "get_toplevel") == 0) {
+            if (wl_resource *toplevel = createResource(client, &xdg_toplevel_interface, version, args[0].n, &noopHandler)) {
+                wl_array states;
+                wl_array_init(&states);
+                xdg_toplevel_send_configure(toplevel, 0, 0, &states);
+                wl_array_release(&states);
+                xdg_surface_send_configure(resource, wl_display_next_serial(display));
+            }
+        } else if (qstrcmp(request, "get_popup") == 0) {
+            if (wl_resource *popup = createResource(client, &xdg_popup_interface, version, args[0].n, &noopHandler)) {
+                xdg_popup_send_configure(popup, 0, 0, 1, 1);
+                xdg_surface_send_configure(resource, wl_display_next_serial(display));
+            }
+        }
+    };
+    xdgOutputManagerHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        if (qstrcmp(request, "get_xdg_output") != 0) {
+            return;
+        }
+        const int version = wl_resource_get_version(resource);
+        wl_resource *xdgOutput = createResource(wl_resource_get_client(resource), &zxdg_output_v1_interface, version, args[0].n, &noopHandler);
+        if (!xdgOutput) {
+            return;
+        }
+        // there is only the one output
+        zxdg_output_v1_send_logical_position(xdgOutput, 0, 0);
+        zxdg_output_v1_send_logical_size(xdgOutput, 1920, 1080);
+        if (version >= ZXDG_OUTPUT_V1_NAME_SINCE_VERSION) {
+            zxdg_output_v1_send_name(xdgOutput, "Mock-1");
+            zxdg_output_v1_send_description(xdgOutput, "KDE Mock");
+        }
+        if (version < 3) {
+            zxdg_output_v1_send_done(xdgOutput);
+        }
+    };
+    subCompositorHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        if (qstrcmp(request, "get_subsurface") == 0) {
+            createResource(wl_resource_get_client(resource), &wl_subsurface_interface, 1, args[0].n, &noopHandler);
+        }
+    };
+    dataDeviceManagerHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        wl_client *client = wl_resource_get_client(resource);
+        const int version = wl_resource_get_version(resource);
+        if (qstrcmp(request, "create_data_source") == 0) {
+            createResource(client, &wl_data_source_interface, version, args[0].n, &noopHandler);
+        } else if (qstrcmp(request, "get_data_device") == 0) {
+            createResource(client, &wl_data_device_interface, version, args[0].n, &noopHandler);
+        }
+    };
+    windowManagementHandler = [this](wl_resource *resource, const char *request, wl_argument *args) {
+        wl_client *client = wl_resource_get_client(resource);
+        if (qstrcmp(request, "get_window") == 0) {
+            const qsizetype index = windowsById.value(args[1].u, -1);
+            createWindow(client, resource, args[0].n, index >= 0 ? &windows.at(index) : nullptr);
+        } else if (qstrcmp(request, "get_window_by_uuid") == 0) {
+            const qsizetype index = windowsByUuid.value(QByteArray(args[1].s), -1);
+            createWindow(client, resource, args[0].n, index >= 0 ? &windows.at(index) : nullptr);
+        }
+    };
+
+    wl_global_create(display, &wl_compositor_interface, 4, this, [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+        auto d = reinterpret_cast<MockCompositor::Private *>(data);
+        d->createResource(client, &wl_compositor_interface, version, id, &d->compositorHandler);
+    });
+    wl_global_create(display, &wl_seat_interface, 5, this, [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+        auto d = reinterpret_cast<MockCompositor::Private *>(data);
+        wl_resource *seat = d->createResource(client, &wl_seat_interface, version, id, &d->seatHandler);
+        if (!seat) {
+            return;
+        }
+        wl_seat_send_capabilities(seat, WL_SEAT_CAPABILITY_POINTER | WL_SEAT_CAPABILITY_KEYBOARD);
+        if (version >= WL_SEAT_NAME_SINCE_VERSION) {
+            wl_seat_send_name(seat, "seat0");
+        }
+    });
+    wl_global_create(display, &wl_output_interface, 4, this, [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+        auto d = reinterpret_cast<MockCompositor::Private *>(data);
+        wl_resource *output = d->createResource(client, &wl_output_interface, version, id, &d->noopHandler);
+        if (!output) {
+            return;
+        }
+        wl_output_send_geometry(output, 0, 0, 520, 290, WL_OUTPUT_SUBPIXEL_UNKNOWN, "KDE", "Mock", WL_OUTPUT_TRANSFORM_NORMAL);
+        wl_output_send_mode(output, WL_OUTPUT_MODE_CURRENT | WL_OUTPUT_MODE_PREFERRED, 1920, 1080, 60000);
+        if (version >= WL_OUTPUT_SCALE_SINCE_VERSION) {
+            wl_output_send_scale(output, 1);
+        }
+        if (version >= WL_OUTPUT_NAME_SINCE_VERSION) {
+            wl_output_send_name(output, "Mock-1");
+        }
+        if (version >= WL_OUTPUT_DONE_SINCE_VERSION) {
+            wl_output_send_done(output);
+        }
+    });
+    wl_global_create(display, &zxdg_output_manager_v1_interface, 3, this, [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+        auto d = reinterpret_cast<MockCompositor::Private *>(data);
+        d->createResource(client, &zxdg_output_manager_v1_interface, version, id, &d->xdgOutputManagerHandler);
+    });
+    wl_global_create(display, &wl_subcompositor_interface, 1, this, [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+        auto d = reinterpret_cast<MockCompositor::Private *>(data);
+        d->createResource(client, &wl_subcompositor_interface, version, id, &d->subCompositorHandler);
+    });
+    wl_global_create(display, &wl_data_device_manager_interface, 3, this, [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+        auto d = reinterpret_cast<MockCompositor::Private *>(data);
+        d->createResource(client, &wl_data_device_manager_interface, version, id, &d->dataDeviceManagerHandler);
+    });
+    wl_global_create(display, &xdg_wm_base_interface, 1, this, [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+        auto d = reinterpret_cast<MockCompositor::Private *>(data);
+        d->createResource(client, &xdg_wm_base_interface, version, id, &d->xdgWmBaseHandler);
+    });
+    wl_global_create(display,
+                     &org_kde_plasma_window_management_interface,
+                     org_kde_plasma_window_management_interface.version,
+                     this,
+                     [](wl_client *client, void *data, uint32_t version, uint32_t id) {
+                         auto d = reinterpret_cast<MockCompositor::Private *>(data);
+                         wl_resource *management =
+                             d->createResource(client, &org_kde_plasma_window_management_interface, version, id, &d->windowManagementHandler);
+                         if (!management) {
+                             return;
+                         }
+                         d->windowManagements << management;
+                         for (const Window &window : std::as_const(d->windows)) {
+                             d->announceWindow(management, window);
+                         }
+                     });
+}
+
+void MockCompositor::Private::announceWindow(wl_resource *management, const Window &window)
+{
+    if (wl_resource_get_version(management) >= ORG_KDE_PLASMA_WINDOW_MANAGEMENT_WINDOW_WITH_UUID_SINCE_VERSION) {
+        org_kde_plasma_window_management_send_window_with_uuid(management, window.id, window.uuid.constData());
+    } else {
+        org_kde_plasma_window_management_send_window(management, window.id);
+    }
+}
+
+void MockCompositor::Private::createWindow(wl_client *client, wl_resource *management, uint32_t id, const Window *window)
+{
+    wl_resource *resource = createResource(client, &org_kde_plasma_window_interface, wl_resource_get_version(management), id, &noopHandler);
+    if (!resource) {
+        return;
+    }
+    if (!window) {
+        org_kde_plasma_window_send_unmapped(resource);
+        return;
+    }
+    org_kde_plasma_window_send_title_changed(resource, window->title.constData());
+    org_kde_plasma_window_send_app_id_changed(resource, "org.kde.mockcompositor");
+    org_kde_plasma_window_send_state_changed(resource, 0);
+    if (wl_resource_get_version(resource) >= ORG_KDE_PLASMA_WINDOW_INITIAL_STATE_SINCE_VERSION) {
+        org_kde_plasma_window_send_initial_state(resource);
+    }
+}
+
+MockCompositor::MockCompositor()
+    : d(new Private)
+{
+}
+
+MockCompositor::~MockCompositor() = default;
+
+int MockCompositor::createClientFd()
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return -1;
+    }
+    run([this, fd = fds[1]] {
+        wl_client_create(d->display, fd);
+    });
+    return fds[0];
+}
+
+void MockCompositor::run(const std::function<void()> &function)
+{
+    QSemaphore done;
+    d->post([&function, &done] {
+        function();
+        done.release();
+    });
+    done.acquire();
+}
+
+void MockCompositor::addWindows(int count)
+{
+    run([this, count] {
+        for (int i = 0; i < count; ++i) {
+            const Private::Window window{
+                d->nextWindowId++,
+                QUuid::createUuid().toByteArray(QUuid::WithoutBraces),
+                QByteArrayLiteral("Window ") + QByteArray::number(d->windows.count()),
+            };
+            d->windowsById.insert(window.id, d->windows.count());
+            d->windowsByUuid.insert(window.uuid, d->windows.count());
+            d->windows << window;
+            for (wl_resource *management : std::as_const(d->windowManagements)) {
+                d->announceWindow(management, window);
+            }
+        }
+        d->windowCount = d->windows.count();
+    });
+}
+
+int MockCompositor::windowCount() const
+{
+    return d->windowCount;
+}
+
+void MockCompositor::sendPointerMotion(int count)
+{
+    run([this, count] {
+        for (wl_resource *pointer : std::as_const(d->pointers)) {
+            wl_client *client = wl_resource_get_client(pointer);
+            auto surface = std::find_if(d->surfaces.crbegin(), d->surfaces.crend(), [client](wl_resource *surface) {
+                return wl_resource_get_client(surface) == client;
+            });
+            if (surface == d->surfaces.crend()) {
+                continue;
+            }
+            wl_pointer_send_enter(pointer, wl_display_next_serial(d->display), *surface, 0, 0);
+            for (int i = 0; i < count; ++i) {
+                wl_pointer_send_motion(pointer, i, wl_fixed_from_int(i % 1920), wl_fixed_from_int(i % 1080));
+                if (wl_resource_get_version(pointer) >= WL_POINTER_FRAME_SINCE_VERSION) {
+                    wl_pointer_send_frame(pointer);
+                }
+            }
+        }
+    });
+}
+
+}
+}
@@ -0,0 +1,66 @@
+/*
+    SPDX-FileCopyrightText: 2026 KWayland Contributors
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#ifndef KWAYLAND_TEST_MOCKCOMPOSITOR_H
+#define KWAYLAND_TEST_MOCKCOMPOSITOR_H
+
+#include <QScopedPointer>
+
+#include <functional>
+
+namespace KWayland
+{
+namespace Test
+{
+/**
+ * A minimal Wayland server for running the client library without a real compositor.
+ *
+ * The MockCompositor runs in its own thread and advertises wl_compositor, wl_shm, wl_seat,
+ * wl_output, zxdg_output_manager_v1, wl_subcompositor, wl_data_device_manager, xdg_wm_base
+ * and org_kde_plasma_window_management, which covers everything Bootstrap binds and the
+ * interfaces the benchmarks need. Requests are accepted but
+ * mostly ignored, the MockCompositor only sends what is needed to bring the client side
+ * objects into a usable state. Clients connect through a socket pair, thus no
+ * WAYLAND_DISPLAY is required.
+ **/
+class MockCompositor
+{
+public:
+    MockCompositor();
+    ~MockCompositor();
+
+    /**
+     * @returns a file descriptor of a new client connection, to be passed to
+     * ConnectionThread::setSocketFd. The caller takes ownership.
+     **/
+    int createClientFd();
+    /**
+     * Runs @p function in the thread of the MockCompositor and waits for it to finish.
+     **/
+    void run(const std::function<void()> &function);
+
+    /**
+     * Adds @p count windows, which get announced to all bound window managements.
+     **/
+    void addWindows(int count);
+    /**
+     * @returns the number of windows
+     **/
+    int windowCount() const;
+    /**
+     * Moves the pointer of every bound wl_pointer @p count times over the latest surface created
+     * by the same client. Each motion is followed by a frame event.
+     **/
+    void sendPointerMotion(int count);
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+}
+}
+
+#endif
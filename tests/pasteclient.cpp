@@ -8,6 +8,7 @@
 #include "../src/client/datadevice.h"
 #include "../src/client/datadevicemanager.h"
 #include "../src/client/dataoffer.h"
+#include "../src/client/datatransfer.h"
 #include "../src/client/event_queue.h"
 #include "../src/client/keyboard.h"
 #include "../src/client/pointer.h"
@@ -19,13 +20,9 @@
 // Qt
 #include <QCoreApplication>
 #include <QDebug>
-#include <QFile>
 #include <QImage>
 #include <QMimeType>
 #include <QThread>
-#include <QtConcurrentRun>
-// system
-#include <unistd.h>
 
 using namespace KWayland::Client;
 
@@ -131,18 +128,11 @@ void PasteClient::setupRegistry(Registry *registry)
             if (it == mimeTypes.constEnd()) {
                 return;
             }
-            int pipeFds[2];
-            if (pipe(pipeFds) != 0) {
-                return;
-            }
-            dataOffer->receive((*it).name(), pipeFds[1]);
-            close(pipeFds[1]);
-            QtConcurrent::run([pipeFds] {
-                QFile readPipe;
-                if (readPipe.open(pipeFds[0], QIODevice::ReadOnly)) {
-                    qDebug() << "Pasted: " << readPipe.readLine();
+            auto transfer = dataOffer->receiveData((*it).name());
+            connect(transfer, &DataTransfer::finished, this, [transfer] {
+                if (transfer->state() == DataTransfer::State::Finished) {
+                    qDebug() << "Pasted: " << transfer->data();
                 }
-                close(pipeFds[0]);
                 QCoreApplication::quit();
             });
         });